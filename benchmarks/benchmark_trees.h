@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+
+// Generators of the XML used by the benchmarks
+
+namespace BT::Benchmark
+{
+
+inline std::string wrapTree(const std::string& body)
+{
+  return "<root BTCPP_format=\"4\">\n<BehaviorTree ID=\"MainTree\">\n" + body +
+         "</BehaviorTree>\n</root>\n";
+}
+
+/// A control node with `width` leaves
+inline std::string wideTree(const std::string& control, const std::string& leaf,
+                            int width)
+{
+  std::string body = "<" + control + ">\n";
+  for (int i = 0; i < width; i++)
+  {
+    body += "  <" + leaf + "/>\n";
+  }
+  body += "</" + control + ">\n";
+  return wrapTree(body);
+}
+
+/// `depth` nested control nodes, with a single leaf
+inline std::string deepTree(const std::string& control, const std::string& leaf,
+                            int depth)
+{
+  std::string body;
+  for (int i = 0; i < depth; i++)
+  {
+    body += "<" + control + ">\n";
+  }
+  body += "<" + leaf + "/>\n";
+  for (int i = 0; i < depth; i++)
+  {
+    body += "</" + control + ">\n";
+  }
+  return wrapTree(body);
+}
+
+/// `depth` nested SubTrees, each one remapping the port "value" of its parent
+inline std::string remappedSubtrees(int depth)
+{
+  std::string xml = "<root BTCPP_format=\"4\" main_tree_to_execute=\"Level0\">\n";
+  for (int i = 0; i < depth; i++)
+  {
+    xml += "<BehaviorTree ID=\"Level" + std::to_string(i) + "\">\n";
+    xml += "  <SubTree ID=\"Level" + std::to_string(i + 1) + "\" value=\"{value}\"/>\n";
+    xml += "</BehaviorTree>\n";
+  }
+  xml += "<BehaviorTree ID=\"Level" + std::to_string(depth) + "\">\n";
+  xml += "  <Script code=\"value := value + 1\"/>\n";
+  xml += "</BehaviorTree>\n</root>\n";
+  return xml;
+}
+
+/// A tree with `subtrees_count` different subtrees, each one with
+/// about 10 nodes, scripts and remapped ports
+inline std::string largeTree(int subtrees_count)
+{
+  std::string xml = "<root BTCPP_format=\"4\" main_tree_to_execute=\"MainTree\">\n";
+  xml += "<BehaviorTree ID=\"MainTree\">\n<Sequence>\n";
+  xml += "  <Script code=\"counter := 0\"/>\n";
+  for (int i = 0; i < subtrees_count; i++)
+  {
+    xml += "  <SubTree ID=\"Sub" + std::to_string(i) + "\" value=\"{counter}\"/>\n";
+  }
+  xml += "</Sequence>\n</BehaviorTree>\n";
+
+  for (int i = 0; i < subtrees_count; i++)
+  {
+    xml += "<BehaviorTree ID=\"Sub" + std::to_string(i) + "\">\n";
+    xml += R"(  <Sequence>
+    <Script code="value += 1" _skipIf="value > 1000"/>
+    <Fallback>
+      <Inverter>
+        <AlwaysSuccess/>
+      </Inverter>
+      <ScriptCondition code="value >= 0"/>
+    </Fallback>
+    <RetryUntilSuccessful num_attempts="3">
+      <AlwaysSuccess/>
+    </RetryUntilSuccessful>
+    <ForceSuccess>
+      <AlwaysFailure/>
+    </ForceSuccess>
+  </Sequence>
+)";
+    xml += "</BehaviorTree>\n";
+  }
+  xml += "</root>\n";
+  return xml;
+}
+
+}   // namespace BT::Benchmark
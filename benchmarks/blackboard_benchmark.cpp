@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include "behaviortree_cpp/bt_factory.h"
+#include "benchmark_trees.h"
+
+// Blackboard::set() and get(), directly on the root blackboard or on the
+// one of a subtree, where the key is remapped through `depth` levels.
+
+using namespace BT;
+
+static Blackboard::Ptr DeepestBlackboard(BehaviorTreeFactory& factory, Tree& tree,
+                                         int depth)
+{
+  auto root_bb = Blackboard::create();
+  root_bb->set("value", 0);
+  tree = factory.createTreeFromText(Benchmark::remappedSubtrees(depth), root_bb);
+  return tree.subtrees.back()->blackboard;
+}
+
+static void BM_BlackboardSet(benchmark::State& state)
+{
+  BehaviorTreeFactory factory;
+  Tree tree;
+  auto bb = DeepestBlackboard(factory, tree, int(state.range(0)));
+  int value = 0;
+  for (auto _ : state)
+  {
+    bb->set("value", value++);
+  }
+}
+
+static void BM_BlackboardGet(benchmark::State& state)
+{
+  BehaviorTreeFactory factory;
+  Tree tree;
+  auto bb = DeepestBlackboard(factory, tree, int(state.range(0)));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(bb->get<int>("value"));
+  }
+}
+
+static void BM_BlackboardGetString(benchmark::State& state)
+{
+  auto bb = Blackboard::create();
+  bb->set("message", std::string("hello world, this is not a short string"));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(bb->get<std::string>("message"));
+  }
+}
+
+// Tick a tree where the only leaf is a Script, incrementing a remapped entry
+static void BM_TickRemappedScript(benchmark::State& state)
+{
+  BehaviorTreeFactory factory;
+  Tree tree;
+  DeepestBlackboard(factory, tree, int(state.range(0)));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tickOnce());
+  }
+}
+
+BENCHMARK(BM_BlackboardSet)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_BlackboardGet)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_BlackboardGetString);
+BENCHMARK(BM_TickRemappedScript)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+
+#include "behaviortree_cpp/bt_factory.h"
+#include "benchmark_trees.h"
+
+// Creation of trees from large XML. The items processed are the subtrees.
+
+using namespace BT;
+
+static void BM_CreateTreeFromText(benchmark::State& state)
+{
+  const std::string xml = Benchmark::largeTree(int(state.range(0)));
+  BehaviorTreeFactory factory;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(factory.createTreeFromText(xml));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * int64_t(xml.size()));
+}
+
+// XML parsed once: only the instantiation of the nodes is measured
+static void BM_CreateRegisteredTree(benchmark::State& state)
+{
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(Benchmark::largeTree(int(state.range(0))));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(factory.createTree("MainTree"));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_CreateTreeFromText)->RangeMultiplier(10)->Range(1, 100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CreateRegisteredTree)
+    ->RangeMultiplier(10)
+    ->Range(1, 100)
+    ->Unit(benchmark::kMicrosecond);
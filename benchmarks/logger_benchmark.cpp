@@ -0,0 +1,132 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+
+#include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/loggers/bt_file_logger_v2.h"
+#include "behaviortree_cpp/loggers/bt_observer.h"
+#include "benchmark_trees.h"
+
+#ifdef BTCPP_SQLITE_LOGGING
+#include "behaviortree_cpp/loggers/bt_sqlite_logger.h"
+#endif
+#ifdef BTCPP_GROOT_INTERFACE
+#include "behaviortree_cpp/loggers/groot2_publisher.h"
+#endif
+
+// Overhead of the loggers. The items processed are the status transitions:
+// compare the time per item with BM_NoLogger.
+
+using namespace BT;
+
+namespace
+{
+class TransitionsCounter : public StatusChangeLogger
+{
+public:
+  TransitionsCounter(const Tree& tree) : StatusChangeLogger(tree.rootNode())
+  {}
+
+  void callback(Duration, const TreeNode&, NodeStatus, NodeStatus) override
+  {
+    count++;
+  }
+
+  void flush() override
+  {}
+
+  int64_t count = 0;
+};
+
+// Temporary file, removed when destroyed
+struct TempFile
+{
+  explicit TempFile(const std::string& filename) :
+    path(std::filesystem::temp_directory_path() / filename)
+  {
+    std::filesystem::remove(path);
+  }
+  ~TempFile()
+  {
+    std::filesystem::remove(path);
+  }
+  std::filesystem::path path;
+};
+}   // namespace
+
+static const int TreeWidth = 100;
+
+static Tree CreateTree(BehaviorTreeFactory& factory)
+{
+  return factory.createTreeFromText(
+      Benchmark::wideTree("Sequence", "AlwaysSuccess", TreeWidth));
+}
+
+static int64_t TransitionsPerTick(Tree& tree)
+{
+  TransitionsCounter counter(tree);
+  tree.tickOnce();
+  return counter.count;
+}
+
+template <typename Logger, typename... Args>
+static void TickWithLogger(benchmark::State& state, Args&&... args)
+{
+  BehaviorTreeFactory factory;
+  auto tree = CreateTree(factory);
+  const int64_t transitions = TransitionsPerTick(tree);
+  {
+    Logger logger(tree, std::forward<Args>(args)...);
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(tree.tickOnce());
+    }
+    // include the transitions still buffered by the logger
+    logger.flush();
+  }
+  state.SetItemsProcessed(state.iterations() * transitions);
+}
+
+static void BM_NoLogger(benchmark::State& state)
+{
+  BehaviorTreeFactory factory;
+  auto tree = CreateTree(factory);
+  const int64_t transitions = TransitionsPerTick(tree);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tickOnce());
+  }
+  state.SetItemsProcessed(state.iterations() * transitions);
+}
+
+static void BM_TreeObserver(benchmark::State& state)
+{
+  TickWithLogger<TreeObserver>(state);
+}
+
+static void BM_FileLogger2(benchmark::State& state)
+{
+  TempFile file("bt_benchmark.btlog");
+  TickWithLogger<FileLogger2>(state, file.path);
+}
+
+#ifdef BTCPP_SQLITE_LOGGING
+static void BM_SqliteLogger(benchmark::State& state)
+{
+  TempFile file("bt_benchmark.db3");
+  TickWithLogger<SqliteLogger>(state, file.path);
+}
+BENCHMARK(BM_SqliteLogger);
+#endif
+
+#ifdef BTCPP_GROOT_INTERFACE
+static void BM_Groot2Publisher(benchmark::State& state)
+{
+  TickWithLogger<Groot2Publisher>(state, 1687u);
+}
+BENCHMARK(BM_Groot2Publisher);
+#endif
+
+BENCHMARK(BM_NoLogger);
+BENCHMARK(BM_TreeObserver);
+BENCHMARK(BM_FileLogger2);
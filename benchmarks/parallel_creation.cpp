@@ -0,0 +1,106 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "behaviortree_cpp/bt_factory.h"
+
+// Measure how many trees per second can be created by several threads
+// sharing the same BehaviorTreeFactory.
+//
+// Usage: bt_parallel_creation_benchmark [max_threads] [trees_per_thread]
+
+static const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code="counter:=0" />
+      <Fallback>
+        <Inverter>
+          <SubTree ID="Increment" value="{counter}" />
+        </Inverter>
+        <SubTree ID="Increment" value="{counter}" />
+      </Fallback>
+      <Parallel success_count="-1" failure_count="1">
+        <SubTree ID="Increment" value="{counter}" />
+        <SubTree ID="Increment" value="{counter}" />
+      </Parallel>
+      <RetryUntilSuccessful num_attempts="3">
+        <ScriptCondition code="counter >= 5" />
+      </RetryUntilSuccessful>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Increment">
+    <Sequence>
+      <Script code="value+=1" _skipIf="value > 100" />
+      <AlwaysSuccess/>
+      <ForceSuccess>
+        <AlwaysFailure/>
+      </ForceSuccess>
+    </Sequence>
+  </BehaviorTree>
+</root>)";
+
+using Clock = std::chrono::steady_clock;
+
+template <typename CreateFunc>
+double TreesPerSecond(int threads_count, int trees_per_thread, CreateFunc create)
+{
+  std::atomic_bool start = false;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; t++)
+  {
+    threads.emplace_back([&]() {
+      while (!start)
+      {
+        std::this_thread::yield();
+      }
+      for (int i = 0; i < trees_per_thread; i++)
+      {
+        auto tree = create();
+      }
+    });
+  }
+  const auto t1 = Clock::now();
+  start = true;
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  const std::chrono::duration<double> elapsed = Clock::now() - t1;
+  return double(threads_count * trees_per_thread) / elapsed.count();
+}
+
+int main(int argc, char** argv)
+{
+  const int max_threads =
+      argc > 1 ? std::stoi(argv[1]) : int(std::max(1u, std::thread::hardware_concurrency()));
+  const int trees_per_thread = argc > 2 ? std::stoi(argv[2]) : 2000;
+
+  BT::BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  // before freeze(), the only safe option is to serialize the creation
+  std::mutex mutex;
+  auto create_locked = [&]() {
+    std::unique_lock lk(mutex);
+    return factory.createTree("MainTree");
+  };
+
+  BT::BehaviorTreeFactory frozen_factory;
+  frozen_factory.registerBehaviorTreeFromText(xml_text);
+  frozen_factory.freeze();
+  auto create_frozen = [&]() { return frozen_factory.createTree("MainTree"); };
+
+  std::cout << "threads | mutex (trees/s) | frozen (trees/s)\n";
+  for (int threads = 1; threads <= max_threads; threads *= 2)
+  {
+    const double locked = TreesPerSecond(threads, trees_per_thread, create_locked);
+    const double frozen = TreesPerSecond(threads, trees_per_thread, create_frozen);
+    std::cout << threads << " | " << int(locked) << " | " << int(frozen) << std::endl;
+  }
+  return 0;
+}
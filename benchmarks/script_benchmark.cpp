@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include "behaviortree_cpp/blackboard.h"
+#include "behaviortree_cpp/scripting/script_parser.hpp"
+
+// Parsing of the scripts, and evaluation of the parsed ones
+
+using namespace BT;
+
+static const char* scripts[] = {
+  "A := 42",
+  "B := A * 2 + 3 - (A / 4)",
+  "C := (A > 10 && B < 100) ? 'large' : 'small'",
+  "D := A + B; E := D * 2; F := E != 0 || D == 0",
+};
+
+static void BM_ParseScript(benchmark::State& state)
+{
+  const std::string script = scripts[state.range(0)];
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(ParseScript(script));
+  }
+}
+
+static void BM_ParseScriptCached(benchmark::State& state)
+{
+  const std::string script = scripts[state.range(0)];
+  ScriptCache cache;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(ParseScript(script, &cache));
+  }
+}
+
+static void BM_EvaluateScript(benchmark::State& state)
+{
+  auto bb = Blackboard::create();
+  Ast::Environment env = {bb, {}};
+  // the later scripts read the variables written by the former ones
+  for (int i = 0; i <= state.range(0); i++)
+  {
+    ParseScript(scripts[i]).value()(env);
+  }
+  auto executor = ParseScript(scripts[state.range(0)]).value();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(executor(env));
+  }
+}
+
+BENCHMARK(BM_ParseScript)->DenseRange(0, 3);
+BENCHMARK(BM_ParseScriptCached)->DenseRange(0, 3);
+BENCHMARK(BM_EvaluateScript)->DenseRange(0, 3);
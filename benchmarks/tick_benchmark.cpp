@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+
+#include "behaviortree_cpp/bt_factory.h"
+#include "benchmark_trees.h"
+
+// Cost of Tree::tickOnce() for trees with many leaves or many levels.
+// The items processed are the ticked nodes.
+
+using namespace BT;
+
+static void TickTree(benchmark::State& state, const std::string& xml, int nodes_count)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tickOnce());
+  }
+  state.SetItemsProcessed(state.iterations() * nodes_count);
+}
+
+static void BM_TickWide(benchmark::State& state, const std::string& control,
+                        const std::string& leaf)
+{
+  const int width = int(state.range(0));
+  TickTree(state, Benchmark::wideTree(control, leaf, width), width + 1);
+}
+
+static void BM_TickDeep(benchmark::State& state, const std::string& control,
+                        const std::string& leaf)
+{
+  const int depth = int(state.range(0));
+  TickTree(state, Benchmark::deepTree(control, leaf, depth), depth + 1);
+}
+
+// In a Fallback, the leaves must fail to tick all of them
+BENCHMARK_CAPTURE(BM_TickWide, Sequence, "Sequence", "AlwaysSuccess")
+    ->RangeMultiplier(10)
+    ->Range(10, 1000);
+BENCHMARK_CAPTURE(BM_TickWide, Fallback, "Fallback", "AlwaysFailure")
+    ->RangeMultiplier(10)
+    ->Range(10, 1000);
+BENCHMARK_CAPTURE(BM_TickWide, ReactiveSequence, "ReactiveSequence", "AlwaysSuccess")
+    ->RangeMultiplier(10)
+    ->Range(10, 1000);
+BENCHMARK_CAPTURE(BM_TickWide, ReactiveFallback, "ReactiveFallback", "AlwaysFailure")
+    ->RangeMultiplier(10)
+    ->Range(10, 1000);
+
+// tinyxml2 does not accept more than 100 nested elements
+BENCHMARK_CAPTURE(BM_TickDeep, Sequence, "Sequence", "AlwaysSuccess")
+    ->RangeMultiplier(4)
+    ->Range(4, 64);
+BENCHMARK_CAPTURE(BM_TickDeep, Fallback, "Fallback", "AlwaysFailure")
+    ->RangeMultiplier(4)
+    ->Range(4, 64);
+BENCHMARK_CAPTURE(BM_TickDeep, ReactiveSequence, "ReactiveSequence", "AlwaysSuccess")
+    ->RangeMultiplier(4)
+    ->Range(4, 64);
+BENCHMARK_CAPTURE(BM_TickDeep, ReactiveFallback, "ReactiveFallback", "AlwaysFailure")
+    ->RangeMultiplier(4)
+    ->Range(4, 64);
@@ -20,6 +20,7 @@
 #include <mutex>
 
 #include "leaf_node.h"
+#include "behaviortree_cpp/utils/thread_pool.h"
 
 namespace BT
 {
@@ -111,6 +112,11 @@ protected:
  *
  * NOTE: when the thread is completed, i.e. the tick() returns its status,
  * a TreeNode::emitWakeUpSignal() will be called.
+ *
+ * The tick() is executed by NodeConfig::executor (see BehaviorTreeFactory::setExecutor())
+ * or, if not specified, by ThreadPool::defaultPool(), that has no limit on the
+ * number of threads. If the action is halted before the executor starts the
+ * task, tick() is not called.
  */
 
 class ThreadedAction : public ActionNodeBase
@@ -120,6 +126,9 @@ public:
     ActionNodeBase(name, config)
   {}
 
+  /// Wait for the completion of the tick(), if it is still running.
+  ~ThreadedAction() override;
+
   bool isHaltRequested() const
   {
     return halt_requested_.load();
@@ -133,6 +142,7 @@ public:
 private:
   std::exception_ptr exptr_;
   std::atomic_bool halt_requested_ = false;
+  std::shared_ptr<Executor> executor_;
   std::future<void> thread_handle_;
   std::mutex mutex_;
 };
@@ -192,6 +202,10 @@ private:
  *
  * It is up to the user to decide when to suspend execution of the Action and resume
  * the parent node, invoking the method setStatusRunningAndYield().
+ *
+ * When the node is created by the BehaviorTreeFactory, the memory of the
+ * coroutine is recycled by the CoroStackPool of the tree, that also decides
+ * the stack size of each node type.
  */
 class CoroActionNode : public ActionNodeBase
 {
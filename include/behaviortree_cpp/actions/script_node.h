@@ -48,6 +48,13 @@ private:
 
   void loadExecutor()
   {
+    // usually the script is a literal: compare it without copying
+    auto port_it = config().input_ports.find("code");
+    if (port_it != config().input_ports.end() && !_script.empty() &&
+        port_it->second == _script && !isBlackboardPointer(port_it->second))
+    {
+      return;
+    }
     std::string script;
     if (!getInput("code", script))
     {
@@ -57,7 +64,7 @@ private:
     {
       return;
     }
-    auto executor = ParseScript(script);
+    auto executor = ParseScript(script, config().script_cache.get());
     if (!executor)
     {
       throw RuntimeError(executor.error());
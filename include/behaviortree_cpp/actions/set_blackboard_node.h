@@ -76,7 +76,9 @@ private:
         config().blackboard->createEntry(output_key, src_entry->info);
         dst_entry = config().blackboard->getEntry(output_key);
       }
+      std::scoped_lock lock(dst_entry->entry_mutex);
       dst_entry->value = src_entry->value;
+      dst_entry->publish();
     }
     else
     {
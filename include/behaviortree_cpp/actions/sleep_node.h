@@ -35,11 +35,13 @@ public:
   }
 
 private:
-  TimerQueue<> timer_;
   uint64_t timer_id_;
 
   std::atomic_bool timer_waiting_ = false;
   std::mutex delay_mutex_;
+
+  // declared last: it must be destroyed before the members used by its handler
+  SharedTimerQueue<> timer_;
 };
 
 }   // namespace BT
@@ -87,8 +87,9 @@ private:
 
   TestNodeConfig _test_config;
   ScriptFunction _executor;
-  TimerQueue<> _timer;
   std::atomic_bool _completed = false;
+
+  SharedTimerQueue<> _timer;
 };
 
 }   // namespace BT
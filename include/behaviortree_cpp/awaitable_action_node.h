@@ -0,0 +1,212 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "behaviortree_cpp/action_node.h"
+#include "behaviortree_cpp/utils/timer_queue.h"
+
+namespace BT
+{
+
+/**
+ * @brief AwaitableActionNode is an asynchronous Action implemented as a
+ * C++20 coroutine. The method run() suspends its execution with co_await,
+ * waiting for:
+ *
+ * - the next tick:                             co_await nextTick();
+ * - some time to pass:                         co_await sleepFor(100ms);
+ * - a call of notify(), from any thread:       co_await notification();
+ * - a new value in the entry of a port:        co_await entryUpdated("goal");
+ *
+ * The node returns RUNNING while it is suspended, and the coroutine is
+ * resumed only by the first tick after the awaited event; the other ticks
+ * return immediately. Timers and notify() call emitWakeUpSignal(), to wake up
+ * a Tree that is sleeping.
+ *
+ * Differently from CoroActionNode, the coroutine is stackless: it needs only
+ * the memory of the local variables of run(), not an entire stack.
+ *
+ * Example:
+ *
+ *     AwaitableActionNode::Task MyAction::run()
+ *     {
+ *       sendRequest();
+ *       co_await notification();   // the reply callback invokes notify()
+ *       co_return replySucceeded() ? NodeStatus::SUCCESS : NodeStatus::FAILURE;
+ *     }
+ */
+class AwaitableActionNode : public ActionNodeBase
+{
+public:
+  /// Type returned by run(). Use co_return to return SUCCESS, FAILURE or SKIPPED.
+  class Task
+  {
+  public:
+    struct promise_type
+    {
+      NodeStatus status = NodeStatus::IDLE;
+      std::exception_ptr exception;
+
+      Task get_return_object()
+      {
+        return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+      std::suspend_always initial_suspend() noexcept
+      {
+        return {};
+      }
+      std::suspend_always final_suspend() noexcept
+      {
+        return {};
+      }
+      void return_value(NodeStatus result)
+      {
+        status = result;
+      }
+      void unhandled_exception()
+      {
+        exception = std::current_exception();
+      }
+    };
+
+    Task() = default;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {}))
+    {}
+
+    Task& operator=(Task&& other) noexcept
+    {
+      if (this != &other)
+      {
+        reset();
+        handle_ = std::exchange(other.handle_, {});
+      }
+      return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+      reset();
+    }
+
+  private:
+    friend class AwaitableActionNode;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle)
+    {}
+
+    void reset()
+    {
+      if (handle_)
+      {
+        handle_.destroy();
+        handle_ = {};
+      }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+  };
+
+  /// The event awaited by the coroutine.
+  struct WaitCondition
+  {
+    enum Type
+    {
+      NEXT_TICK,
+      DEADLINE,
+      NOTIFICATION,
+      ENTRY_UPDATE
+    };
+    Type type = NEXT_TICK;
+    std::chrono::steady_clock::time_point deadline;
+    std::shared_ptr<Blackboard::Entry> entry;
+    uint64_t sequence_id = 0;
+  };
+
+  /// Returned by nextTick(), sleepFor(), notification() and entryUpdated().
+  class Awaiter
+  {
+  public:
+    Awaiter(AwaitableActionNode* node, WaitCondition condition) :
+      node_(node), condition_(std::move(condition))
+    {}
+
+    bool await_ready()
+    {
+      return condition_.type != WaitCondition::NEXT_TICK &&
+             node_->isSatisfied(condition_);
+    }
+
+    void await_suspend(std::coroutine_handle<>)
+    {
+      node_->suspendUntil(std::move(condition_));
+    }
+
+    void await_resume() const noexcept
+    {}
+
+  private:
+    AwaitableActionNode* node_;
+    WaitCondition condition_;
+  };
+
+  AwaitableActionNode(const std::string& name, const NodeConfig& config);
+
+  ~AwaitableActionNode() override;
+
+  /**
+   * @brief notify resumes the coroutine waiting for notification().
+   * If it isn't waiting yet, the following notification() returns immediately.
+   * Thread-safe.
+   */
+  void notify();
+
+  /** You may want to override this method. But still, remember to call this
+    * implementation too. It destroys the coroutine (and its local variables).
+    */
+  void halt() override;
+
+protected:
+  /// The body of the Action.
+  virtual Task run() = 0;
+
+  /// Resume at the next tick.
+  [[nodiscard]] Awaiter nextTick();
+
+  /// Resume at the first tick after the timeout.
+  [[nodiscard]] Awaiter sleepFor(std::chrono::milliseconds timeout);
+
+  /// Resume at the first tick after notify().
+  [[nodiscard]] Awaiter notification();
+
+  /// Resume at the first tick after a new value is written into the blackboard
+  /// entry remapped to this port.
+  [[nodiscard]] Awaiter entryUpdated(const std::string& port_name);
+
+private:
+  NodeStatus tick() override final;
+
+  bool isSatisfied(const WaitCondition& condition);
+
+  void suspendUntil(WaitCondition condition);
+
+  void cancelTimer();
+
+  Task task_;
+  WaitCondition condition_;
+  std::atomic_bool notified_ = false;
+  std::atomic_bool timer_waiting_ = false;
+  uint64_t timer_id_ = 0;
+
+  // declared last: it must be destroyed before the members used by its handler
+  SharedTimerQueue<> timer_;
+};
+
+}   // namespace BT
@@ -15,6 +15,7 @@
 
 #include "behaviortree_cpp/controls/parallel_node.h"
 #include "behaviortree_cpp/controls/parallel_all_node.h"
+#include "behaviortree_cpp/controls/concurrent_parallel_node.h"
 #include "behaviortree_cpp/controls/reactive_sequence.h"
 #include "behaviortree_cpp/controls/reactive_fallback.h"
 #include "behaviortree_cpp/controls/fallback_node.h"
@@ -25,6 +26,7 @@
 #include "behaviortree_cpp/controls/while_do_else_node.h"
 
 #include "behaviortree_cpp/action_node.h"
+#include "behaviortree_cpp/awaitable_action_node.h"
 #include "behaviortree_cpp/condition_node.h"
 
 #include "behaviortree_cpp/decorators/inverter_node.h"
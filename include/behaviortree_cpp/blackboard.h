@@ -5,13 +5,17 @@
 #include <memory>
 #include <stdint.h>
 #include <unordered_map>
+#include <vector>
 #include <mutex>
+#include <atomic>
 #include <sstream>
 
 #include "behaviortree_cpp/basic_types.h"
 #include "behaviortree_cpp/utils/safe_any.hpp"
 #include "behaviortree_cpp/exceptions.h"
 #include "behaviortree_cpp/utils/locked_reference.hpp"
+#include "behaviortree_cpp/utils/seqlock.hpp"
+#include "behaviortree_cpp/utils/symbol_table.h"
 
 namespace BT
 {
@@ -23,12 +27,19 @@ using AnyPtrLocked = LockedPtr<Any>;
 /**
  * @brief The Blackboard is the mechanism used by BehaviorTrees to exchange
  * typed data.
+ *
+ * The keys are interned in SymbolTable::global(): the methods that accept
+ * a KeyID, instead of a string, skip the hashing of the key.
+ * The interned strings are never released, so the table grows with the
+ * number of distinct key names used by the process. Avoid generating
+ * keys at runtime (e.g. with a counter in the name).
  */
 class Blackboard
 {
 
 public:
   using Ptr = std::shared_ptr<Blackboard>;
+  using KeyID = SymbolTable::ID;
 
 protected:
   // This is intentionally protected. Use Blackboard::create instead
@@ -37,15 +48,37 @@ protected:
 
 public:
 
+  /// Copy of an Entry value that can be read without locking.
+  /// See Blackboard::enableLockFreeRead()
+  struct LockFreeValue
+  {
+    SeqLock storage;
+    std::type_index type = typeid(void);
+    void (*publish)(const Any& value, SeqLock& storage) = nullptr;
+  };
+
   struct Entry
   {
     Any value;
     TypeInfo info;
     StringConverter string_converter;
     mutable std::mutex entry_mutex;
-    
+    std::unique_ptr<LockFreeValue> lockfree;
+    /// Incremented by publish(), i.e. every time the value is written.
+    std::atomic<uint64_t> sequence_id = 0;
+
     Entry(const TypeInfo& _info) : info(_info)
     {}
+
+    /// To be called after modifying value, while entry_mutex is still locked.
+    void publish()
+    {
+      sequence_id.fetch_add(1, std::memory_order_release);
+      if (lockfree && !value.empty())
+      {
+        lockfree->publish(value, lockfree->storage);
+      }
+    }
   };
 
   /** Use this static method to create an instance of the BlackBoard
@@ -60,25 +93,46 @@ public:
 
   void enableAutoRemapping(bool remapping);
 
-  [[nodiscard]] const std::shared_ptr<Entry> getEntry(const std::string& key) const;
+  /// The ID of a key, that can be used instead of the string.
+  [[nodiscard]] static KeyID keyID(StringView key)
+  {
+    return SymbolTable::global().intern(key);
+  }
+
+  [[nodiscard]] const std::shared_ptr<Entry> getEntry(StringView key) const;
+
+  [[nodiscard]] std::shared_ptr<Blackboard::Entry> getEntry(StringView key);
+
+  [[nodiscard]] const std::shared_ptr<Entry> getEntry(KeyID key) const;
 
-  [[nodiscard]] std::shared_ptr<Blackboard::Entry> getEntry(const std::string& key);
+  [[nodiscard]] std::shared_ptr<Blackboard::Entry> getEntry(KeyID key);
+
+  /**
+   * @brief getAnyLocked gives access to the Any stored in an entry.
+   *
+   * NOTE: if you modify the value of an entry, call Entry::publish() before
+   * releasing the lock (needed by enableLockFreeRead() and Entry::sequence_id),
+   * or use set() instead.
+   */
+  [[nodiscard]] AnyPtrLocked getAnyLocked(StringView key);
 
-  [[nodiscard]] AnyPtrLocked getAnyLocked(const std::string& key);
+  [[nodiscard]] AnyPtrLocked getAnyLocked(StringView key) const;
 
-  [[nodiscard]] AnyPtrLocked getAnyLocked(const std::string& key) const;
+  [[nodiscard]] AnyPtrLocked getAnyLocked(KeyID key);
+
+  [[nodiscard]] AnyPtrLocked getAnyLocked(KeyID key) const;
 
   [[deprecated("Use getAnyLocked instead")]]
-  const Any* getAny(const std::string& key) const;
+  const Any* getAny(StringView key) const;
 
   [[deprecated("Use getAnyLocked instead")]]
-  Any* getAny(const std::string& key);
+  Any* getAny(StringView key);
 
   /** Return true if the entry with the given key was found.
    *  Note that this method may throw an exception if the cast to T failed.
    */
   template <typename T> [[nodiscard]]
-  bool get(const std::string& key, T& value) const
+  bool get(StringView key, T& value) const
   {
     if (auto any_ref = getAnyLocked(key))
     {
@@ -92,7 +146,7 @@ public:
    * Version of get() that throws if it fails.
    */
   template <typename T> [[nodiscard]]
-  T get(const std::string& key) const
+  T get(StringView key) const
   {
     if (auto any_ref = getAnyLocked(key))
     {
@@ -111,13 +165,23 @@ public:
 
   /// Update the entry with the given key
   template <typename T>
-  void set(const std::string& key, const T& value)
+  void set(StringView key, const T& value)
+  {
+    set(keyID(key), value);
+  }
+
+  template <typename T>
+  void set(KeyID key, const T& value)
   {
     std::unique_lock lock(mutex_);
 
     // check local storage
-    auto it = storage_.find(key);
-    if (it == storage_.end())
+    auto entry_ptr = findLocal(key);
+    if (!entry_ptr)
+    {
+      entry_ptr = takeRemapped(key);
+    }
+    if (!entry_ptr)
     {
       // create a new entry
       Any new_value(value);
@@ -135,98 +199,186 @@ public:
       }
       lock.lock();
 
-      storage_.insert( {key, entry} );
       entry->value = new_value;
     }
     else
     {
       // this is not the first time we set this entry, we need to check
       // if the type is the same or not.
-      Entry& entry = *it->second;
-      std::scoped_lock scoped_lock(entry.entry_mutex);
+      setEntry(SymbolTable::global().str(key), **entry_ptr, value);
+    }
+  }
 
-      Any& previous_any = entry.value;
+  /**
+   * @brief setEntry updates an Entry previously obtained with getEntry().
+   * It performs the same type checking of set(), but it doesn't need
+   * to look for the key in the storage.
+   *
+   * @param key   used only for error messages.
+   */
+  template <typename T>
+  void setEntry(StringView key, Entry& entry, const T& value)
+  {
+    std::scoped_lock scoped_lock(entry.entry_mutex);
 
-      Any new_value(value);
+    Any& previous_any = entry.value;
 
-      // special case: entry exists but it is not strongly typed... yet
-      if (!entry.info.isStronglyTyped())
-      {
-        // Use the new type to create a new entry that is strongly typed.
-        entry.info = TypeInfo::Create<T>();
-        previous_any = std::move(new_value);
-        return;
-      }
+    Any new_value(value);
+
+    // special case: entry exists but it is not strongly typed... yet
+    if (!entry.info.isStronglyTyped())
+    {
+      // Use the new type to create a new entry that is strongly typed.
+      entry.info = TypeInfo::Create<T>();
+      previous_any = std::move(new_value);
+      entry.publish();
+      return;
+    }
 
-      std::type_index previous_type = entry.info.type();
+    std::type_index previous_type = entry.info.type();
 
-      // check type mismatch
-      if (previous_type != std::type_index(typeid(T)) &&
-          previous_type != new_value.type())
+    // check type mismatch
+    if (previous_type != std::type_index(typeid(T)) &&
+        previous_type != new_value.type())
+    {
+      bool mismatching = true;
+      if (std::is_constructible<StringView, T>::value)
       {
-        bool mismatching = true;
-        if (std::is_constructible<StringView, T>::value)
+        Any any_from_string = entry.info.parseString(value);
+        if (any_from_string.empty() == false)
         {
-          Any any_from_string = entry.info.parseString(value);
-          if (any_from_string.empty() == false)
-          {
-            mismatching = false;
-            new_value = std::move(any_from_string);
-          }
+          mismatching = false;
+          new_value = std::move(any_from_string);
         }
-        // check if we are doing a safe cast between numbers
-        // for instance, it is safe to use int(100) to set
-        // a uint8_t port, but not int(-42) or int(300)
-        if constexpr(std::is_arithmetic_v<T>)
-        {
-          if(mismatching && isCastingSafe(previous_type, value))
-          {
-            mismatching = false;
-          }
-        }
-
-        if (mismatching)
+      }
+      // check if we are doing a safe cast between numbers
+      // for instance, it is safe to use int(100) to set
+      // a uint8_t port, but not int(-42) or int(300)
+      if constexpr(std::is_arithmetic_v<T>)
+      {
+        if(mismatching && isCastingSafe(previous_type, value))
         {
-          debugMessage();
-
-          auto msg = StrCat("Blackboard::set(", key, "): once declared, "
-                            "the type of a port shall not change. "
-                            "Previously declared type [", BT::demangle(previous_type),
-                            "], current type [", BT::demangle(typeid(T)), "]");
-          throw LogicError(msg);
+          mismatching = false;
         }
       }
-      // if doing set<BT::Any>, skip type check
-      if constexpr(std::is_same_v<Any, T>)
+
+      if (mismatching)
       {
-        previous_any = new_value;
-      }
-      else {
-        // copy only if the type is compatible
-        new_value.copyInto(previous_any);
+        debugMessage();
+
+        auto msg = StrCat("Blackboard::set(", key, "): once declared, "
+                          "the type of a port shall not change. "
+                          "Previously declared type [", BT::demangle(previous_type),
+                          "], current type [", BT::demangle(typeid(T)), "]");
+        throw LogicError(msg);
       }
     }
+    // if doing set<BT::Any>, skip type check
+    if constexpr(std::is_same_v<Any, T>)
+    {
+      previous_any = new_value;
+    }
+    else {
+      // copy only if the type is compatible
+      new_value.copyInto(previous_any);
+    }
+    entry.publish();
   }
 
-  void unset(const std::string& key)
+  /**
+   * @brief enableLockFreeRead is an opt-in mode for entries that contain
+   * small trivially copyable values (double, int64_t, small structs up to 16 bytes).
+   *
+   * A copy of the value is kept in a SeqLock and updated by every write;
+   * getLockFree() (and InputPortHandle<T>) read it without locking
+   * any mutex, so that readers in other threads never block the writer.
+   *
+   * The entry is created, if it doesn't exist.
+   * It should be called before the tree is ticked.
+   */
+  template <typename T>
+  void enableLockFreeRead(StringView key)
   {
-    std::unique_lock lock(mutex_);
+    static_assert(SeqLock::IsSupported<T>(),
+                  "enableLockFreeRead requires a trivially copyable type, "
+                  "with size up to 16 bytes");
+    auto entry = getEntry(key);
+    if (!entry)
+    {
+      createEntry(key, TypeInfo::Create<T>());
+      entry = getEntry(key);
+    }
+    std::scoped_lock lock(entry->entry_mutex);
+    if (!entry->info.isStronglyTyped())
+    {
+      entry->info = TypeInfo::Create<T>();
+    }
+    if (entry->info.type() != typeid(T))
+    {
+      throw LogicError("Blackboard::enableLockFreeRead(", key, "): the type of "
+                       "the entry is [", BT::demangle(entry->info.type()),
+                       "], not [", BT::demangle(typeid(T)), "]");
+    }
+    auto lockfree = std::make_unique<LockFreeValue>();
+    lockfree->type = typeid(T);
+    lockfree->publish = [](const Any& value, SeqLock& storage) {
+      storage.store(value.cast<T>());
+    };
+    entry->lockfree = std::move(lockfree);
+    entry->publish();
+  }
 
-    // check local storage
-    auto it = storage_.find(key);
-    if (it == storage_.end())
+  /**
+   * @brief getLockFree reads the value of an Entry without locking it.
+   *
+   * @return false if the entry doesn't use enableLockFreeRead(),
+   * T is not the type of the entry or the entry was never written.
+   */
+  template <typename T>
+  static bool getLockFree(const Entry& entry, T& value)
+  {
+    if constexpr (SeqLock::IsSupported<T>())
     {
-      // No entry, nothing to do.
-      return;
+      const auto* lockfree = entry.lockfree.get();
+      if (lockfree && lockfree->type == typeid(T))
+      {
+        return lockfree->storage.load(value);
+      }
     }
+    return false;
+  }
+
+  void unset(StringView key);
 
-    storage_.erase(it);
+  /// Incremented every time unset() or clear() remove entries.
+  /// Who caches the pointers returned by getEntry() can use it to
+  /// detect that they might be outdated.
+  [[nodiscard]] uint64_t removedEntriesCount() const
+  {
+    return removed_entries_.load(std::memory_order_relaxed);
   }
 
-  [[nodiscard]] const TypeInfo* entryInfo(const std::string& key);
+  [[nodiscard]] const TypeInfo* entryInfo(StringView key);
 
   void addSubtreeRemapping(StringView internal, StringView external);
 
+  /**
+   * @brief Link the entries of the parent blackboard that are visible through
+   * the subtree remapping, so that their lookup doesn't need to climb the
+   * hierarchy.
+   *
+   * The links are kept apart from the entries of this blackboard, and
+   * getKeys(), entryInfo() and debugMessage() don't report them; an entry
+   * becomes local, as before, only when it is written or accessed with
+   * the non-const getEntry().
+   *
+   * The parent should be resolved first: in that case, the entries
+   * of all the ancestors are found with a single local lookup.
+   * Autoremapped keys, and entries created later in the parent, are
+   * still found (and cached) by getEntry().
+   */
+  void resolveRemappedEntries();
+
   void debugMessage() const;
 
   [[nodiscard]] std::vector<StringView> getKeys() const;
@@ -236,18 +388,39 @@ public:
   [[deprecated("Use getAnyLocked to access safely an Entry")]]
   std::recursive_mutex& entryMutex() const;
   
-  void createEntry(const std::string& key, const TypeInfo& info);
+  void createEntry(StringView key, const TypeInfo& info);
 
 private:
   mutable std::mutex mutex_;
   mutable std::recursive_mutex entry_mutex_;
-  std::unordered_map<std::string, std::shared_ptr<Entry>> storage_;
+  // Keyed by the interned ID: the memory used is proportional to the
+  // number of entries of this blackboard, not to the size of the SymbolTable.
+  std::unordered_map<KeyID, std::shared_ptr<Entry>> storage_;
+  // entries of the ancestors, linked by resolveRemappedEntries()
+  std::unordered_map<KeyID, std::shared_ptr<Entry>> remapped_entries_;
   std::weak_ptr<Blackboard> parent_bb_;
-  std::unordered_map<std::string, std::string> internal_to_external_;
-  
-  std::shared_ptr<Entry> createEntryImpl(const std::string &key, const TypeInfo& info);
+  std::unordered_map<KeyID, KeyID> internal_to_external_;
+
+  // these four must be called with mutex_ locked
+  std::shared_ptr<Entry>* findLocal(KeyID key)
+  {
+    auto it = storage_.find(key);
+    return it == storage_.end() ? nullptr : &it->second;
+  }
+  const std::shared_ptr<Entry>* findLocal(KeyID key) const
+  {
+    return const_cast<Blackboard*>(this)->findLocal(key);
+  }
+  void insertLocal(KeyID key, std::shared_ptr<Entry> entry);
+  // move an entry linked by resolveRemappedEntries() to the local storage,
+  // as it would happen by looking it up in the parent
+  std::shared_ptr<Entry>* takeRemapped(KeyID key);
+
+  std::shared_ptr<Entry> createEntryImpl(KeyID key, const TypeInfo& info);
 
   bool autoremapping_ = false;
+
+  std::atomic<uint64_t> removed_entries_ = 0;
 };
 
 }   // namespace BT
@@ -26,6 +26,7 @@
 
 #include "behaviortree_cpp/contrib/magic_enum.hpp"
 #include "behaviortree_cpp/behavior_tree.h"
+#include "behaviortree_cpp/utils/coro_stack_pool.h"
 
 namespace BT
 {
@@ -87,6 +88,93 @@ constexpr const char* PLUGIN_SYMBOL = "BT_RegisterNodesFromPlugin";
 
 bool WildcardMatch(const std::string &str, StringView filter);
 
+/**
+ * @brief ManifestsSnapshot is a read-only copy of the manifests registered
+ * in a BehaviorTreeFactory.
+ *
+ * The copy is shared by all the trees created by the factory and it is
+ * created again only when the manifests change, therefore copying a
+ * ManifestsSnapshot is cheap.
+ *
+ * NOTE: it replaces the std::unordered_map previously stored in Tree::manifests.
+ * The read-only interface of the map is provided and a ManifestsSnapshot
+ * converts implicitly to a const reference to the map, but the manifests of a
+ * Tree can not be modified anymore (for instance with the operator[]).
+ */
+class ManifestsSnapshot
+{
+public:
+  using Map = std::unordered_map<std::string, TreeNodeManifest>;
+  using const_iterator = Map::const_iterator;
+
+  ManifestsSnapshot() = default;
+
+  explicit ManifestsSnapshot(std::shared_ptr<const Map> map) : map_(std::move(map))
+  {}
+
+  /// Create a new snapshot, not shared with any other tree.
+  ManifestsSnapshot& operator=(Map map)
+  {
+    map_ = std::make_shared<const Map>(std::move(map));
+    return *this;
+  }
+
+  [[nodiscard]] const Map& map() const
+  {
+    static const Map empty_map;
+    return map_ ? *map_ : empty_map;
+  }
+
+  operator const Map&() const
+  {
+    return map();
+  }
+
+  /// Trees created with the same snapshot share the same pointer.
+  [[nodiscard]] const std::shared_ptr<const Map>& shared() const
+  {
+    return map_;
+  }
+
+  [[nodiscard]] const_iterator begin() const
+  {
+    return map().begin();
+  }
+
+  [[nodiscard]] const_iterator end() const
+  {
+    return map().end();
+  }
+
+  [[nodiscard]] const_iterator find(const std::string& ID) const
+  {
+    return map().find(ID);
+  }
+
+  [[nodiscard]] const TreeNodeManifest& at(const std::string& ID) const
+  {
+    return map().at(ID);
+  }
+
+  [[nodiscard]] size_t count(const std::string& ID) const
+  {
+    return map().count(ID);
+  }
+
+  [[nodiscard]] size_t size() const
+  {
+    return map().size();
+  }
+
+  [[nodiscard]] bool empty() const
+  {
+    return map().empty();
+  }
+
+private:
+  std::shared_ptr<const Map> map_;
+};
+
 /**
  * @brief Struct used to store a tree.
  * If this object goes out of scope, the tree is destroyed.
@@ -105,7 +193,10 @@ public:
   };
 
   std::vector<Subtree::Ptr> subtrees;
-  std::unordered_map<std::string, TreeNodeManifest> manifests;
+  ManifestsSnapshot manifests;
+  /// Memory of the coroutines of the CoroActionNodes, reused when
+  /// the actions are restarted.
+  std::shared_ptr<CoroStackPool> coro_stack_pool;
 
   Tree();
 
@@ -147,6 +238,17 @@ public:
 
   [[nodiscard]] Blackboard::Ptr rootBlackboard();
 
+  /// The signal emitted by TreeNode::emitWakeUpSignal() (null before initialize())
+  [[nodiscard]] const std::shared_ptr<WakeUpSignal>& wakeUpSignal() const
+  {
+    return wake_up_;
+  }
+
+  /// True if at least one node has a status change observer (typically,
+  /// a logger). See TreeNode::hasStatusObservers().
+  /// It reads a counter updated by the nodes: it doesn't visit the tree.
+  [[nodiscard]] bool observersAttached() const;
+
   //Call the visitor for each node of the tree.
   void applyVisitor(const std::function<void(const TreeNode*)>& visitor);
 
@@ -178,6 +280,8 @@ public:
 
 private:
   std::shared_ptr<WakeUpSignal> wake_up_;
+  // the number of nodes with status observers, see observersAttached()
+  std::shared_ptr<std::atomic<size_t>> observed_nodes_;
 
   enum TickOption
   {
@@ -192,6 +296,42 @@ private:
 };
 
 class Parser;
+class XMLParser;
+
+/**
+ * @brief TreeTemplate is the compiled version of a <BehaviorTree>: the XML
+ * was already parsed and validated, and the ports, remappings and
+ * configurations of all the nodes are precomputed.
+ *
+ * Creating a Tree from a template requires only the instantiation of the
+ * nodes and the blackboards. Use it when the same tree is created many times.
+ *
+ * See BehaviorTreeFactory::createTreeTemplate().
+ * The factory that created the template must outlive it.
+ * Copying a TreeTemplate is cheap, since the data is shared.
+ */
+class TreeTemplate
+{
+public:
+  TreeTemplate();
+
+  /// Create a new instance of the tree.
+  [[nodiscard]] Tree instantiate(Blackboard::Ptr blackboard = Blackboard::create()) const;
+
+  /// ID of the main tree. Empty if the template is not valid.
+  [[nodiscard]] const std::string& treeID() const;
+
+  /// Number of nodes, including the ones in the subtrees.
+  [[nodiscard]] size_t nodesCount() const;
+
+  struct PImpl;
+
+private:
+  friend class XMLParser;
+  explicit TreeTemplate(std::shared_ptr<const PImpl> pimpl);
+
+  std::shared_ptr<const PImpl> _p;
+};
 
 /**
  * @brief The BehaviorTreeFactory is used to create instances of a
@@ -199,6 +339,12 @@ class Parser;
  *
  * Some node types are "builtin", whilst other are used defined and need
  * to be registered using a unique ID.
+ *
+ * Thread safety: the methods that register or remove nodes, trees,
+ * enums and substitution rules must not be called concurrently with any
+ * other method. Once freeze() is called, these registries become immutable
+ * and createTree(), createTreeTemplate(), createTreeFromText() and
+ * createTreeFromFile() can be invoked from multiple threads at the same time.
  */
 class BehaviorTreeFactory
 {
@@ -391,6 +537,12 @@ public:
   [[nodiscard]]
   const std::unordered_map<std::string, TreeNodeManifest>& manifests() const;
 
+  /// Same content of manifests(), but shared with the trees.
+  /// It is copied only if the manifests changed since the last call.
+  /// It can be called concurrently from multiple threads, but not concurrently
+  /// with the methods that register or modify the manifests.
+  [[nodiscard]] ManifestsSnapshot manifestsSnapshot() const;
+
   /// List of builtin IDs.
   [[nodiscard]]
   const std::set<std::string>& builtinNodes() const;
@@ -429,6 +581,70 @@ public:
   Tree createTree(const std::string& tree_name,
                   Blackboard::Ptr blackboard = Blackboard::create());
 
+  /**
+   * @brief createTreeTemplate parses and validates a registered tree once;
+   * the returned TreeTemplate can then create many instances of it.
+   *
+   * The nodes used by the template must not be unregistered while it is in use.
+   *
+   * @param tree_name  ID of a tree registered with registerBehaviorTreeFromText()
+   *                   or registerBehaviorTreeFromFile().
+   */
+  [[nodiscard]]
+  TreeTemplate createTreeTemplate(const std::string& tree_name);
+
+  /**
+   * @brief freeze makes the factory immutable: any further attempt to
+   * register or remove nodes, trees, enums or substitution rules
+   * will throw a LogicError.
+   *
+   * All the registered trees are compiled into a TreeTemplate, that
+   * createTree() will use without locking any mutex.
+   * This allows multiple threads to create trees from the same factory.
+   *
+   * freeze() itself must be called before sharing the factory with other threads.
+   */
+  void freeze();
+
+  [[nodiscard]] bool frozen() const;
+
+  /**
+   * @brief enableNodeArena changes the way the trees are created:
+   * all the TreeNodes of a tree will be allocated from a single NodeArena,
+   * in depth-first order. This improves memory locality when ticking large
+   * trees and makes their destruction faster.
+   *
+   * Disabled by default.
+   */
+  void enableNodeArena(bool enable);
+
+  [[nodiscard]] bool nodeArenaEnabled() const;
+
+  /**
+   * @brief scriptCache contains the scripts already parsed by this factory
+   * (Script nodes, pre and post conditions, etc.), so that nodes sharing the
+   * same code don't need to parse it again.
+   * It can be cleared at any time.
+   */
+  [[nodiscard]] std::shared_ptr<ScriptCache> scriptCache() const;
+
+  /**
+   * @brief setExecutor changes the Executor used by the ThreadedActions of the
+   * trees created afterward. By default (nullptr), ThreadPool::defaultPool() is used.
+   */
+  void setExecutor(std::shared_ptr<Executor> executor);
+
+  [[nodiscard]] std::shared_ptr<Executor> executor() const;
+
+  /**
+   * @brief setCoroStackPoolOptions changes the options of the CoroStackPool
+   * owned by each tree created afterward (stack size of the CoroActionNodes,
+   * measurement of the stack usage).
+   */
+  void setCoroStackPoolOptions(CoroStackPool::Options options);
+
+  [[nodiscard]] const CoroStackPool::Options& coroStackPoolOptions() const;
+
   /// Add metadata to a specific manifest. This metadata will be added
   /// to <TreeNodesModel> with the function writeTreeNodesModelXML()
   void addMetadataToManifest(const std::string& node_id,
@@ -45,6 +45,16 @@ public:
   virtual Tree instantiateTree(const Blackboard::Ptr& root_blackboard,
                                std::string tree_name = {}) = 0;
 
+  /**
+   * @brief createTreeTemplate validates the tree and stores everything needed
+   * to instantiate it, without parsing the document again.
+   * By default, it is not supported.
+   */
+  virtual TreeTemplate createTreeTemplate(std::string tree_name = {})
+  {
+    throw RuntimeError("This parser doesn't support createTreeTemplate(): ", tree_name);
+  }
+
   virtual void clearInternalState(){};
 };
 
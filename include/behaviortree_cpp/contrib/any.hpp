@@ -20,6 +20,12 @@
 #include <type_traits>
 #include <stdexcept>
 
+// Size in bytes of the storage used for values that don't need a heap allocation.
+// The original implementation uses 2 * sizeof(void*).
+#ifndef ANY_IMPL_STACK_SIZE
+#define ANY_IMPL_STACK_SIZE (2 * sizeof(void*))
+#endif
+
 namespace linb
 {
 class bad_any_cast : public std::bad_cast
@@ -164,11 +170,14 @@ class any final
   private:   // Storage and Virtual Method Table
     union storage_union
     {
+        static_assert(ANY_IMPL_STACK_SIZE >= 2 * sizeof(void*),
+                      "ANY_IMPL_STACK_SIZE must be at least 2 * sizeof(void*)");
+
         using stack_storage_t =
-            typename std::aligned_storage<2 * sizeof(void*), std::alignment_of<void*>::value>::type;
+            typename std::aligned_storage<ANY_IMPL_STACK_SIZE, std::alignment_of<void*>::value>::type;
 
         void* dynamic;
-        stack_storage_t stack;   // 2 words for e.g. shared_ptr
+        stack_storage_t stack;   // at least 2 words for e.g. shared_ptr
     };
 
     /// Base VTable specification.
@@ -290,6 +299,22 @@ class any final
         return &table;
     }
 
+  public:
+    /// Same as any_cast<T>(this), without checking the type.
+    /// The caller must be sure that the type is T and that it is not empty.
+    template <typename T>
+    const T* unchecked_cast() const noexcept
+    {
+        return cast<T>();
+    }
+
+    /// Whether a value of type T is stored without a heap allocation.
+    template <typename T>
+    static constexpr bool is_stored_inline() noexcept
+    {
+        return !requires_allocation<typename std::decay<T>::type>::value;
+    }
+
   protected:
     template <typename T>
     friend const T* any_cast(const any* operand) noexcept;
@@ -0,0 +1,91 @@
+/* Copyright (C) 2024 Davide Faconti -  All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <vector>
+#include "behaviortree_cpp/control_node.h"
+#include "behaviortree_cpp/utils/thread_pool.h"
+
+namespace BT
+{
+/**
+ * @brief The ConcurrentParallelNode works like ParallelAllNode, but the
+ * children are ticked __in separate threads__, using the Executor of the
+ * factory (or ThreadPool::defaultPool()). The tick returns when all the
+ * children have been ticked; it is useful when the children perform
+ * expensive synchronous work.
+ *
+ * The children share the blackboard, which is thread-safe, but two children
+ * should not use the same entry unless they are designed to do so.
+ * The children listed in the port "tick_thread_children" (for instance "0;2")
+ * are considered not thread-safe: they are ticked one after the other,
+ * in the thread that ticks the tree, while the other children are running.
+ *
+ * While waiting, the thread that ticks the tree runs itself the children
+ * that the Executor didn't start yet: the tick never waits for a busy
+ * Executor, and nested ConcurrentParallel nodes can not deadlock.
+ *
+ * Halting happens always in the thread that ticks the tree.
+ *
+ * Keep in mind that the status change callbacks (loggers, observers) of the
+ * children are invoked by the worker threads.
+ */
+class ConcurrentParallelNode : public ControlNode
+{
+public:
+  ConcurrentParallelNode(const std::string& name, const NodeConfig& config);
+
+  static PortsList providedPorts()
+  {
+    return {InputPort<int>("max_failures", 1,
+                           "If the number of children returning FAILURE exceeds this value, "
+                           "ConcurrentParallel returns FAILURE"),
+            InputPort<std::vector<int>>("tick_thread_children",
+                                        "Indexes of the children that must be ticked "
+                                        "in the thread of the tree, separated by ';'")};
+  }
+
+  ~ConcurrentParallelNode() override = default;
+
+  virtual void halt() override;
+
+  size_t failureThreshold() const;
+  void setFailureThreshold(int threshold);
+
+private:
+  size_t failure_threshold_;
+
+  std::vector<bool> completed_;
+  size_t completed_count_ = 0;
+  size_t failure_count_ = 0;
+
+  std::vector<NodeStatus> statuses_;
+  std::vector<std::exception_ptr> exceptions_;
+  std::vector<size_t> concurrent_children_;
+  std::vector<size_t> tick_thread_children_;
+  std::shared_ptr<Executor> executor_;
+
+  // the children dispatched to the executor, shared with its tasks
+  struct Dispatch;
+  std::shared_ptr<Dispatch> dispatch_;
+
+  void tickChild(size_t index);
+
+  void runDispatched(Dispatch& dispatch, size_t slot);
+
+  virtual BT::NodeStatus tick() override;
+};
+
+}   // namespace BT
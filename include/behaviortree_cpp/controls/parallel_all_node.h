@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include <set>
+#include <vector>
 #include "behaviortree_cpp/control_node.h"
 
 namespace BT
@@ -53,10 +53,13 @@ public:
 private:
   size_t failure_threshold_;
 
-  std::set<size_t> completed_list_;
+  std::vector<bool> completed_list_;
+  size_t completed_count_ = 0;
   size_t failure_count_ = 0;
 
   virtual BT::NodeStatus tick() override;
+
+  void clear();
 };
 
 }   // namespace BT
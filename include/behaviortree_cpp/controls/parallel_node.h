@@ -13,7 +13,7 @@
 
 #pragma once
 
-#include <set>
+#include <vector>
 #include "behaviortree_cpp/control_node.h"
 
 namespace BT
@@ -66,7 +66,8 @@ private:
   int success_threshold_;
   int failure_threshold_;
   
-  std::set<size_t> completed_list_;
+  // allocated once: std::set would allocate a node per completed child
+  std::vector<bool> completed_list_;
 
   size_t success_count_ = 0;
   size_t failure_count_ = 0;
@@ -51,7 +51,6 @@ public:
   void halt() override;
 
 private:
-  TimerQueue<> timer_;
   uint64_t timer_id_;
 
   virtual BT::NodeStatus tick() override;
@@ -62,6 +61,8 @@ private:
   unsigned msec_;
   bool read_parameter_from_ports_ = false;
   std::mutex delay_mutex_;
+
+  SharedTimerQueue<> timer_;
 };
 
 }   // namespace BT
@@ -74,7 +74,7 @@ private:
     {
       return;
     }
-    auto executor = ParseScript(script);
+    auto executor = ParseScript(script, config().script_cache.get());
     if (!executor)
     {
       throw RuntimeError(executor.error());
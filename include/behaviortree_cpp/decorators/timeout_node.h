@@ -72,14 +72,15 @@ private:
 
   void halt() override;
 
-  TimerQueue<> timer_;
   std::atomic_bool child_halted_ = false;
   uint64_t timer_id_;
 
   unsigned msec_;
   bool read_parameter_from_ports_;
   std::atomic_bool timeout_started_ = false;
-  std::mutex timeout_mutex_;
+
+  // keep it last: pending handlers are drained before the other members are destroyed
+  SharedTimerQueue<> timer_;
 };
 
 }   // namespace BT
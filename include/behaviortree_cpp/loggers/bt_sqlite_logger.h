@@ -20,10 +20,39 @@ namespace BT
  * This is primarily meant to be used with Groot2, but the content of
  * the tables is sufficiently self-explaining, and you can create
  * your own tools to extract the information.
+ *
+ * Transitions are written by a separate thread; each batch of transitions
+ * is inserted with a single prepared statement inside one transaction.
+ * See SqliteLogger::Options to tune the journal and the size of the queue.
  */
 class SqliteLogger : public StatusChangeLogger
 {
 public:
+  /// What to do when the queue of pending transitions is full.
+  enum class OverflowPolicy
+  {
+    /// the thread ticking the tree waits until the writer catches up
+    BLOCK,
+    /// the new transition is discarded
+    DROP_NEWEST,
+    /// the oldest transition in the queue is discarded
+    DROP_OLDEST
+  };
+
+  struct Options
+  {
+    /// if true, add this recording to the database
+    bool append = false;
+    /// use "PRAGMA journal_mode=WAL"
+    bool wal_mode = false;
+    /// value of "PRAGMA synchronous": "OFF", "NORMAL", "FULL" or "EXTRA".
+    /// If empty, the default of SQLite is used.
+    std::string synchronous;
+    /// maximum number of transitions waiting to be written; 0 means unbounded.
+    size_t max_queue_size = 0;
+    OverflowPolicy overflow_policy = OverflowPolicy::BLOCK;
+  };
+
   /**
    * @brief To correctly read this log with Groot2, you must use the suffix ".db3".
    * Constructor will throw otherwise.
@@ -36,6 +65,10 @@ public:
                std::filesystem::path const& file,
                bool append = false);
 
+  SqliteLogger(const Tree &tree,
+               std::filesystem::path const& file,
+               const Options& options);
+
   virtual ~SqliteLogger() override;
 
   virtual void callback(Duration timestamp,
@@ -45,7 +78,16 @@ public:
 
   virtual void flush() override;
 
+  /// Number of transitions discarded because the queue was full,
+  /// or because writing them in the database failed.
+  size_t droppedTransitions() const
+  {
+    return dropped_transitions_;
+  }
+
 private:
+  Options options_;
+
   std::unique_ptr<sqlite::Connection> db_;
 
   int64_t monotonic_timestamp_ = 0;
@@ -62,7 +104,9 @@ private:
 
   std::deque<Transition> transitions_queue_;
   std::condition_variable queue_cv_;
+  std::condition_variable queue_space_cv_;
   std::mutex queue_mutex_;
+  std::atomic_size_t dropped_transitions_ = 0;
 
   std::thread writer_thread_;
   std::atomic_bool loop_ = true;
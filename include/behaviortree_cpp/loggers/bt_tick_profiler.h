@@ -0,0 +1,94 @@
+#ifndef BT_TICK_PROFILER_H
+#define BT_TICK_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/contrib/json.hpp"
+
+namespace BT
+{
+
+/**
+ * @brief The TickProfiler measures the duration of each TreeNode::executeTick()
+ * of a tree, using TreeNode::setTickMonitorCallback().
+ *
+ * For each node, it collects:
+ *
+ * - the inclusive time: the entire executeTick(), children included;
+ * - the self time: the inclusive time, minus the inclusive time of the children.
+ *
+ * Both are stored as totals and as histograms with power-of-two buckets,
+ * that can be written as a table, as JSON or as "folded stacks"
+ * (the input of flamegraph.pl).
+ *
+ * The profiler replaces the callbacks previously set with setTickMonitorCallback(),
+ * and removes them when destroyed. The results should be read when the tree
+ * is not being ticked, and the profiler must not be destroyed while the tree
+ * is being ticked. It can outlive the tree.
+ */
+class TickProfiler
+{
+public:
+  /// Bucket 0 contains the durations shorter than 1 ns, bucket i the durations
+  /// in the interval [2^(i-1), 2^i) ns. The last one contains everything longer.
+  static constexpr size_t BucketsCount = 40;
+
+  using Histogram = std::array<uint64_t, BucketsCount>;
+
+  struct NodeStatistics
+  {
+    uint16_t uid = 0;
+    std::string path;
+    std::string registration_name;
+    uint64_t ticks = 0;
+
+    std::chrono::nanoseconds inclusive_total = {};
+    std::chrono::nanoseconds inclusive_max = {};
+    Histogram inclusive_histogram = {};
+
+    std::chrono::nanoseconds self_total = {};
+    std::chrono::nanoseconds self_max = {};
+    Histogram self_histogram = {};
+  };
+
+  /// Upper bound of the bucket where the percentile (0-100) is found.
+  static std::chrono::nanoseconds percentile(const Histogram& histogram, double percentile);
+
+  explicit TickProfiler(const Tree& tree);
+
+  TickProfiler(const TickProfiler&) = delete;
+  TickProfiler& operator=(const TickProfiler&) = delete;
+
+  ~TickProfiler();
+
+  void reset();
+
+  /// All the nodes, in the same order of Tree::subtrees
+  [[nodiscard]] std::vector<NodeStatistics> statistics() const;
+
+  /// Find the statistics of a node, based on its TreeNode::UID()
+  [[nodiscard]] NodeStatistics statistics(uint16_t uid) const;
+
+  /// Human readable table, with times in microseconds.
+  void writeTable(std::ostream& os) const;
+
+  [[nodiscard]] nlohmann::json toJson() const;
+
+  /// One line per node, with the names of its ancestors and
+  /// its self time in microseconds, for instance "Root;Sequence;MoveBase 42".
+  void writeFoldedStacks(std::ostream& os) const;
+
+private:
+  struct PImpl;
+  std::unique_ptr<PImpl> _p;
+};
+
+}   // namespace BT
+
+#endif   // BT_TICK_PROFILER_H
@@ -0,0 +1,188 @@
+/*  Copyright (C) 2022 Davide Faconti -  All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "behaviortree_cpp/scripting/script_parser.hpp"
+
+namespace BT::Ast
+{
+struct ExprBase;
+
+/**
+ * @brief Program is the compiled version of a script: a flat list of
+ * instructions working on a set of registers.
+ *
+ * Sub-expressions made only of literals are evaluated once, at compilation
+ * time, and the blackboard entries are referenced by index (slot).
+ *
+ * A Program is immutable; it is executed by a ProgramExecutor.
+ */
+class Program
+{
+public:
+  enum class OpCode : uint8_t
+  {
+    LOAD_VAR,         // dst = slot[a]; op != 0 if a number is enough
+    UNARY,            // dst = op(a)
+    BINARY,           // dst = a op b
+    COMPARE,          // if !(a op b) { dst = 0; jump to target }
+    JUMP_IF_FALSE,    // if !a jump to target
+    JUMP,             // jump to target
+    MOVE,             // dst = a
+    CREATE_ENTRY,     // create the entry slot[a], if needed
+    ASSIGN,           // slot[a] op= b; dst = slot[a]
+    FAIL              // throw RuntimeError(messages[a])
+  };
+
+  struct Instruction
+  {
+    OpCode code;
+    uint8_t op = 0;
+    uint32_t dst = 0;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint32_t target = 0;
+  };
+
+  /// Operands with this bit set refer to a constant, not a register.
+  static constexpr uint32_t CONSTANT_BIT = 1u << 31;
+
+  /// A register or a constant. Numbers can be stored without
+  /// creating an Any.
+  struct Value
+  {
+    Any any;
+    double number = 0;
+    bool has_any = false;
+    bool has_number = false;
+
+    void setNumber(double value)
+    {
+      number = value;
+      has_number = true;
+      has_any = false;
+    }
+
+    void setAny(Any value)
+    {
+      any = std::move(value);
+      has_any = true;
+      has_number = false;
+    }
+
+    [[nodiscard]] Any toAny() const
+    {
+      return has_any ? any : Any(number);
+    }
+  };
+
+  /**
+   * @brief compile a list of expressions, as created by the parser.
+   *
+   * @param exprs   the expressions, executed in sequence.
+   * @param source  the original script, used in the error messages.
+   */
+  static std::shared_ptr<const Program> compile(const std::vector<std::shared_ptr<ExprBase>>& exprs,
+                                                const std::string& source);
+
+  [[nodiscard]] const std::vector<Instruction>& instructions() const
+  {
+    return instructions_;
+  }
+
+  [[nodiscard]] const std::vector<Value>& constants() const
+  {
+    return constants_;
+  }
+
+  /// Names of the blackboard entries used by this program
+  [[nodiscard]] const std::vector<std::string>& slots() const
+  {
+    return slots_;
+  }
+
+  [[nodiscard]] const std::vector<std::string>& messages() const
+  {
+    return messages_;
+  }
+
+  [[nodiscard]] size_t registersCount() const
+  {
+    return registers_count_;
+  }
+
+  /// Operand containing the value returned by the script
+  [[nodiscard]] uint32_t result() const
+  {
+    return result_;
+  }
+
+  [[nodiscard]] const std::string& source() const
+  {
+    return source_;
+  }
+
+private:
+  friend class ProgramCompiler;
+
+  std::vector<Instruction> instructions_;
+  std::vector<Value> constants_;
+  std::vector<std::string> slots_;
+  std::vector<std::string> messages_;
+  size_t registers_count_ = 0;
+  uint32_t result_ = 0;
+  std::string source_;
+};
+
+/**
+ * @brief ProgramExecutor runs a Program. It is the callable
+ * wrapped by the ScriptFunction returned by ParseScript().
+ *
+ * Like the AST it replaces, it can be invoked concurrently and recursively:
+ * the registers live in a thread-local scratch space, and the blackboard
+ * entries used by the program are cached in an immutable snapshot,
+ * that is replaced only when the Environment changes.
+ */
+class ProgramExecutor
+{
+public:
+  explicit ProgramExecutor(std::shared_ptr<const Program> program);
+
+  ProgramExecutor(const ProgramExecutor& other);
+  ProgramExecutor& operator=(const ProgramExecutor& other);
+
+  Any operator()(Environment& env) const;
+
+  [[nodiscard]] const Program& program() const
+  {
+    return *program_;
+  }
+
+private:
+  struct SlotsCache;
+
+  std::shared_ptr<const Program> program_;
+  // read and written with std::atomic_load / std::atomic_store
+  mutable std::shared_ptr<const SlotsCache> cache_;
+
+  std::shared_ptr<const SlotsCache> resolveSlots(Environment& env) const;
+
+  Any run(Environment& env) const;
+};
+
+}   // namespace BT::Ast
@@ -100,7 +100,11 @@ struct ExprUnaryArithmetic : ExprBase
 
   Any evaluate(Environment& env) const override
   {
-    auto rhs_v = rhs->evaluate(env);
+    return apply(op, rhs->evaluate(env));
+  }
+
+  static Any apply(op_t op, const Any& rhs_v)
+  {
     if (rhs_v.isNumber())
     {
       const double rv = rhs_v.cast<double>();
@@ -140,6 +144,11 @@ struct ExprBinaryArithmetic : ExprBase
   } op;
 
   const char* opStr() const
+  {
+    return opStr(op);
+  }
+
+  static const char* opStr(op_t op)
   {
     switch (op)
     {
@@ -175,14 +184,18 @@ struct ExprBinaryArithmetic : ExprBase
   {
     auto lhs_v = lhs->evaluate(env);
     auto rhs_v = rhs->evaluate(env);
+    return apply(op, lhs_v, rhs_v);
+  }
 
+  static Any apply(op_t op, const Any& lhs_v, const Any& rhs_v)
+  {
     if (lhs_v.empty())
     {
-      throw RuntimeError(ErrorNotInit("left", opStr()));
+      throw RuntimeError(ErrorNotInit("left", opStr(op)));
     }
     if (rhs_v.empty())
     {
-      throw RuntimeError(ErrorNotInit("right", opStr()));
+      throw RuntimeError(ErrorNotInit("right", opStr(op)));
     }
 
     if (rhs_v.isNumber() && lhs_v.isNumber())
@@ -291,7 +304,7 @@ struct ExprComparison : ExprBase
     greater_equal
   };
 
-  const char* opStr(op_t op) const
+  static const char* opStr(op_t op)
   {
     switch (op)
     {
@@ -316,92 +329,72 @@ struct ExprComparison : ExprBase
 
   Any evaluate(Environment& env) const override
   {
-    auto SwitchImpl = [&](const auto& lv, const auto& rv, op_t op) {
-      switch (op)
-      {
-        case equal:
-          if (!IsSame(lv, rv))
-            return false;
-          break;
-        case not_equal:
-          if (IsSame(lv, rv))
-            return false;
-          break;
-        case less:
-          if (lv >= rv)
-            return false;
-          break;
-        case greater:
-          if (lv <= rv)
-            return false;
-          break;
-        case less_equal:
-          if (lv > rv)
-            return false;
-          break;
-        case greater_equal:
-          if (lv < rv)
-            return false;
-          break;
-      }
-      return true;
-    };
-
     auto lhs_v = operands[0]->evaluate(env);
     for (auto i = 0u; i != ops.size(); ++i)
     {
       auto rhs_v = operands[i + 1]->evaluate(env);
-
-      if (lhs_v.empty())
-      {
-        throw RuntimeError(ErrorNotInit("left", opStr(ops[i])));
-      }
-      if (rhs_v.empty())
+      if (!compare(ops[i], lhs_v, rhs_v))
       {
-        throw RuntimeError(ErrorNotInit("right", opStr(ops[i])));
-      }
-      const Any False(0.0);
-
-      if (lhs_v.isNumber() && rhs_v.isNumber())
-      {
-        auto lv = lhs_v.cast<double>();
-        auto rv = rhs_v.cast<double>();
-        if (!SwitchImpl(lv, rv, ops[i]))
-        {
-          return False;
-        }
-      }
-      else if (lhs_v.isString() && rhs_v.isString())
-      {
-        auto lv = lhs_v.cast<SimpleString>();
-        auto rv = rhs_v.cast<SimpleString>();
-        if (!SwitchImpl(lv, rv, ops[i]))
-        {
-          return False;
-        }
-      }
-      else if ((lhs_v.isString() && rhs_v.isNumber()) ||
-               (lhs_v.isNumber() && rhs_v.isString()))
-      {
-        auto lv = lhs_v.cast<double>();
-        auto rv = lhs_v.cast<double>();
-        if (!SwitchImpl(lv, rv, ops[i]))
-        {
-          return False;
-        }
-      }
-      else
-      {
-        throw RuntimeError(StrCat("Can't mix different types in Comparison. "
-                                  "Left operand [",
-                                  BT::demangle(lhs_v.type()),
-                                  "] right operand [",
-                                  BT::demangle(rhs_v.type()), "]"));
+        return Any(0.0);
       }
       lhs_v = rhs_v;
     }
     return Any(1.0);
   }
+
+  template <typename T>
+  static bool compare(op_t op, const T& lv, const T& rv)
+  {
+    switch (op)
+    {
+      case equal:
+        return IsSame(lv, rv);
+      case not_equal:
+        return !IsSame(lv, rv);
+      case less:
+        return !(lv >= rv);
+      case greater:
+        return !(lv <= rv);
+      case less_equal:
+        return !(lv > rv);
+      case greater_equal:
+        return !(lv < rv);
+    }
+    return true;
+  }
+
+  static bool compare(op_t op, const Any& lhs_v, const Any& rhs_v)
+  {
+    if (lhs_v.empty())
+    {
+      throw RuntimeError(ErrorNotInit("left", opStr(op)));
+    }
+    if (rhs_v.empty())
+    {
+      throw RuntimeError(ErrorNotInit("right", opStr(op)));
+    }
+
+    if (lhs_v.isNumber() && rhs_v.isNumber())
+    {
+      return compare(op, lhs_v.cast<double>(), rhs_v.cast<double>());
+    }
+    else if (lhs_v.isString() && rhs_v.isString())
+    {
+      return compare(op, lhs_v.cast<SimpleString>(), rhs_v.cast<SimpleString>());
+    }
+    else if ((lhs_v.isString() && rhs_v.isNumber()) ||
+             (lhs_v.isNumber() && rhs_v.isString()))
+    {
+      auto lv = lhs_v.cast<double>();
+      auto rv = lhs_v.cast<double>();
+      return compare(op, lv, rv);
+    }
+    throw RuntimeError(StrCat("Can't mix different types in Comparison. "
+                              "Left operand [",
+                              BT::demangle(lhs_v.type()),
+                              "] right operand [",
+                              BT::demangle(rhs_v.type()), "]"));
+  }
 };
 
 struct ExprIf : ExprBase
@@ -414,10 +407,7 @@ struct ExprIf : ExprBase
 
   Any evaluate(Environment& env) const override
   {
-    const auto& v = condition->evaluate(env);
-    bool valid = (v.isType<SimpleString>() && v.cast<SimpleString>().size() > 0) ||
-                 (v.cast<double>() != 0.0);
-    if (valid)
+    if (isTrue(condition->evaluate(env)))
     {
       return then->evaluate(env);
     }
@@ -426,6 +416,12 @@ struct ExprIf : ExprBase
       return else_->evaluate(env);
     }
   }
+
+  static bool isTrue(const Any& v)
+  {
+    return (v.isType<SimpleString>() && v.cast<SimpleString>().size() > 0) ||
+           (v.cast<double>() != 0.0);
+  }
 };
 
 struct ExprAssignment : ExprBase
@@ -441,6 +437,11 @@ struct ExprAssignment : ExprBase
   } op;
 
   const char* opStr() const
+  {
+    return opStr(op);
+  }
+
+  static const char* opStr(op_t op)
   {
     switch (op)
     {
@@ -478,27 +479,41 @@ struct ExprAssignment : ExprBase
     auto entry = env.vars->getEntry(key);
     if (!entry)
     {
-      // variable doesn't exist, create it if using operator assign_create
-      if (op == assign_create)
-      {
-        env.vars->createEntry(key, PortInfo());
-        entry = env.vars->getEntry(key);
-      }
-      else
-      {
-        // fail otherwise
-        auto msg = StrCat("The blackboard entry [", key,
-                          "] doesn't exist, yet.\n"
-                          "If you want to create a new one, "
-                          "use the operator "
-                          "[:=] instead of [=]");
-        throw RuntimeError(msg);
-      }
+      entry = createEntry(env, key, op);
     }
     auto value = rhs->evaluate(env);
 
-    std::scoped_lock lock(entry->entry_mutex);
-    auto dst_ptr = &entry->value;
+    Any result;
+    assign(env, *entry, key, op, value, &result);
+    return result;
+  }
+
+  /// Called when the entry doesn't exist, yet.
+  /// Only the operator assign_create is allowed to create it.
+  static std::shared_ptr<Blackboard::Entry> createEntry(Environment& env,
+                                                        const std::string& key, op_t op)
+  {
+    if (op == assign_create)
+    {
+      env.vars->createEntry(key, PortInfo());
+      return env.vars->getEntry(key);
+    }
+    // fail otherwise
+    auto msg = StrCat("The blackboard entry [", key,
+                      "] doesn't exist, yet.\n"
+                      "If you want to create a new one, "
+                      "use the operator "
+                      "[:=] instead of [=]");
+    throw RuntimeError(msg);
+  }
+
+  /// Assign the value to the entry. If result is not null, it will contain a copy of
+  /// the new value of the entry.
+  static void assign(Environment& env, Blackboard::Entry& entry, const std::string& key,
+                     op_t op, const Any& value, Any* result)
+  {
+    std::scoped_lock lock(entry.entry_mutex);
+    auto dst_ptr = &entry.value;
 
     auto errorPrefix = [dst_ptr, &key]() {
       return StrCat("Error assigning a value to entry [", key, "] with type [",
@@ -507,14 +522,14 @@ struct ExprAssignment : ExprBase
 
     if (value.empty())
     {
-      throw RuntimeError(ErrorNotInit("right", opStr()));
+      throw RuntimeError(ErrorNotInit("right", opStr(op)));
     }
 
     if (op == assign_create || op == assign_existing)
     {
       // the very fist assignment can come from any type.
       // In the future, type check will be done by Any::copyInto
-      if (dst_ptr->empty() && entry->info.type() == typeid(AnyTypeAllowed))
+      if (dst_ptr->empty() && entry.info.type() == typeid(AnyTypeAllowed))
       {
         *dst_ptr = value;
       }
@@ -551,12 +566,17 @@ struct ExprAssignment : ExprBase
           throw RuntimeError(msg);
         }
       }
-      return *dst_ptr;
+      entry.publish();
+      if (result)
+      {
+        *result = *dst_ptr;
+      }
+      return;
     }
 
     if (dst_ptr->empty())
     {
-      throw RuntimeError(ErrorNotInit("left", opStr()));
+      throw RuntimeError(ErrorNotInit("left", opStr(op)));
     }
 
     // temporary use
@@ -605,7 +625,11 @@ struct ExprAssignment : ExprBase
     }
 
     temp_variable.copyInto(*dst_ptr);
-    return *dst_ptr;
+    entry.publish();
+    if (result)
+    {
+      *result = *dst_ptr;
+    }
   }
 };
 }   // namespace BT::Ast
@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
 #include "behaviortree_cpp/blackboard.h"
 
 namespace BT
@@ -43,6 +47,44 @@ using ScriptFunction = std::function<Any(Ast::Environment& env)>;
 
 Expected<ScriptFunction> ParseScript(const std::string& script);
 
+/**
+ * @brief ScriptCache stores the result of ParseScript(), using the script
+ * itself as key, to avoid parsing many times the same code.
+ *
+ * Each call of parse() returns its own copy of the ScriptFunction.
+ * It is thread-safe.
+ */
+class ScriptCache
+{
+public:
+  Expected<ScriptFunction> parse(const std::string& script);
+
+  [[nodiscard]] size_t hits() const
+  {
+    return hits_;
+  }
+
+  [[nodiscard]] size_t misses() const
+  {
+    return misses_;
+  }
+
+  /// Number of scripts in the cache
+  [[nodiscard]] size_t size() const;
+
+  void clear();
+
+private:
+  // many readers, when trees are created concurrently
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, Expected<ScriptFunction>> scripts_;
+  std::atomic_size_t hits_ = 0;
+  std::atomic_size_t misses_ = 0;
+};
+
+/// Same as ParseScript(script), but use the cache, if not null.
+Expected<ScriptFunction> ParseScript(const std::string& script, ScriptCache* cache);
+
 Expected<Any> ParseScriptAndExecute(Ast::Environment& env,
                                     const std::string& script);
 
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+
+#include "behaviortree_cpp/bt_factory.h"
+
+namespace BT
+{
+
+/**
+ * @brief TreeExecutor ticks many trees using a fixed number of worker threads,
+ * instead of a thread per tree calling Tree::tickWhileRunning().
+ *
+ * Each tree is ticked with Tree::tickExactlyOnce() at its own period, as long
+ * as it returns RUNNING. When a node invokes TreeNode::emitWakeUpSignal() the
+ * tree is ticked again as soon as possible, without waiting for the period.
+ *
+ * Each worker has its own queue of trees ready to be ticked; idle workers
+ * steal work from the others.
+ * A tree is never ticked by two workers at the same time, but consecutive
+ * ticks may happen in different threads.
+ */
+class TreeExecutor
+{
+public:
+  using TreeID = uint64_t;
+
+  /// Invoked when the tree returns SUCCESS or FAILURE, or throws an exception.
+  using CompletionCallback = std::function<void(NodeStatus status, std::exception_ptr error)>;
+
+  struct Stats
+  {
+    uint64_t ticks = 0;
+    /// Trees ticked by a worker that stole them from another one.
+    uint64_t steals = 0;
+    /// Ticks anticipated by emitWakeUpSignal().
+    uint64_t wakeups = 0;
+  };
+
+  /// @param threads number of workers. If 0, std::thread::hardware_concurrency().
+  explicit TreeExecutor(size_t threads = 0);
+
+  TreeExecutor(const TreeExecutor&) = delete;
+  TreeExecutor& operator=(const TreeExecutor&) = delete;
+
+  /// Stop the workers and halt the trees that are still running.
+  ~TreeExecutor();
+
+  /**
+   * @brief add a tree; the first tick happens as soon as possible.
+   *
+   * @param tree          the tree to tick. It must be initialized (as the trees
+   *                      created by the BehaviorTreeFactory are).
+   * @param period        time between the beginning of two consecutive ticks.
+   *                      If 0, the tree is ticked only when woken up.
+   * @param on_completed  optional callback, invoked by a worker thread.
+   */
+  TreeID add(std::shared_ptr<Tree> tree, std::chrono::milliseconds period,
+             CompletionCallback on_completed = {});
+
+  /**
+   * @brief remove stops ticking a tree (waiting for the current tick to
+   * be completed, if any) and halts it. The callback is not invoked.
+   *
+   * @return false if the tree was not found (for instance, it was completed).
+   */
+  bool remove(TreeID id);
+
+  /// Block until all the trees are completed or removed.
+  void waitAll();
+
+  /// Number of trees currently executed
+  [[nodiscard]] size_t treesCount() const;
+
+  [[nodiscard]] size_t threadsCount() const;
+
+  [[nodiscard]] Stats stats() const;
+
+private:
+  struct PImpl;
+  std::unique_ptr<PImpl> _p;
+};
+
+}   // namespace BT
@@ -13,15 +13,21 @@
 
 #pragma once
 
+#include <atomic>
 #include <exception>
 #include <map>
+#include <mutex>
+#include <new>
+#include <typeindex>
 #include <utility>
+#include <optional>
 
 #include "behaviortree_cpp/utils/signal.h"
 #include "behaviortree_cpp/basic_types.h"
 #include "behaviortree_cpp/blackboard.h"
 #include "behaviortree_cpp/utils/strcat.hpp"
 #include "behaviortree_cpp/utils/wakeup_signal.hpp"
+#include "behaviortree_cpp/utils/node_arena.hpp"
 #include "behaviortree_cpp/scripting/script_parser.hpp"
 
 #ifdef _MSC_VER
@@ -70,6 +76,9 @@ std::string toStr<BT::PreCond>(const BT::PreCond& status);
 
 using ScriptingEnumsRegistry = std::unordered_map<std::string, int>;
 
+class Executor;
+class CoroStackPool;
+
 struct NodeConfig
 {
   NodeConfig()
@@ -79,6 +88,12 @@ struct NodeConfig
   Blackboard::Ptr blackboard;
   // List of enums available for scripting
   std::shared_ptr<ScriptingEnumsRegistry> enums;
+  // Used to parse the scripts (may be null)
+  std::shared_ptr<ScriptCache> script_cache;
+  // Used to run the asynchronous actions (may be null)
+  std::shared_ptr<Executor> executor;
+  // Memory of the coroutines used by CoroActionNode (may be null)
+  std::shared_ptr<CoroStackPool> coro_stack_pool;
   // input ports
   PortsRemapping input_ports;
   // output ports
@@ -102,6 +117,12 @@ struct NodeConfig
 using NodeConfiguration = NodeConfig;
 
 
+template <typename T>
+class InputPortHandle;
+
+template <typename T>
+class OutputPortHandle;
+
 template <typename T>
 inline constexpr bool hasNodeNameCtor()
 {
@@ -141,6 +162,27 @@ public:
 
   virtual ~TreeNode();
 
+  /// TreeNodes are allocated from NodeArena::current(), if any,
+  /// or the heap otherwise.
+  static void* operator new(std::size_t size);
+  static void operator delete(void* ptr);
+
+  // over-aligned types and placement new don't use the arena
+  static void* operator new(std::size_t size, std::align_val_t align)
+  {
+    return ::operator new(size, align);
+  }
+  static void operator delete(void* ptr, std::align_val_t align)
+  {
+    ::operator delete(ptr, align);
+  }
+  static void* operator new(std::size_t, void* place) noexcept
+  {
+    return place;
+  }
+  static void operator delete(void*, void*) noexcept
+  {}
+
   /// The method that should be used to invoke tick() and setStatus();
   virtual BT::NodeStatus executeTick();
 
@@ -167,6 +209,8 @@ public:
       std::function<NodeStatus(TreeNode&)>;
   using PostTickCallback =
       std::function<NodeStatus(TreeNode&, NodeStatus)>;
+  using TickMonitorCallback =
+      std::function<void(TreeNode&, NodeStatus, std::chrono::nanoseconds)>;
 
   /**
      * @brief subscribeToStatusChange is used to attach a callback to a status change.
@@ -179,6 +223,10 @@ public:
      */
   [[nodiscard]] StatusChangeSubscriber subscribeToStatusChange(StatusChangeCallback callback);
 
+  /// True if a callback was subscribed with subscribeToStatusChange().
+  /// When false, status changes are not signalled at all.
+  [[nodiscard]] bool hasStatusObservers() const;
+
   /** This method attaches to the TreeNode a callback with signature:
      *
      *     Optional<NodeStatus> myCallback(TreeNode& node)
@@ -200,6 +248,20 @@ public:
    */
   void setPostTickFunction(PostTickCallback callback);
 
+  /**
+   * This method attaches to the TreeNode a callback with signature:
+   *
+   *     void myCallback(TreeNode& node, NodeStatus status, std::chrono::nanoseconds duration)
+   *
+   * This callback is executed at the end of every executeTick(), with the
+   * returned status and the duration of the call (including the pre and post
+   * conditions and the ticks of the children). See TickProfiler.
+   *
+   * If the tick throws an exception, the callback is executed with
+   * NodeStatus::IDLE before the exception is propagated.
+   */
+  void setTickMonitorCallback(TickMonitorCallback callback);
+
   /// The unique identifier of this instance of treeNode.
   /// It is assigneld by the factory
   [[nodiscard]] uint16_t UID() const;
@@ -294,6 +356,12 @@ public:
   static Expected<StringView> getRemappedKey(StringView port_name,
                                              StringView remapped_port);
 
+  /// Same as getRemappedKey(), but it doesn't allocate an error message:
+  /// return false if remapped_port is not a blackboard pointer.
+  [[nodiscard]]
+  static bool getRemappedKey(StringView port_name, StringView remapped_port,
+                             StringView& remapped_key);
+
   /// Notify that the tree should be ticked again()
   void emitWakeUpSignal();
 
@@ -319,6 +387,7 @@ public:
     {
       auto node_ptr = new DerivedT(name, args...);
       node_ptr->config() = config;
+      node_ptr->resolvePorts();
       return std::unique_ptr<DerivedT>(node_ptr);
     }
   }
@@ -342,6 +411,10 @@ protected:
 
   void setWakeUpInstance(std::shared_ptr<WakeUpSignal> instance);
 
+  // The number of nodes of the Tree that have status observers,
+  // kept up to date by this node. See Tree::observersAttached()
+  void setObservedNodesCounter(std::shared_ptr<std::atomic<size_t>> counter);
+
   void modifyPortsRemapping(const PortsRemapping& new_remapping);
 
   /**
@@ -354,17 +427,83 @@ protected:
   using PreScripts = std::array<ScriptFunction, size_t(PreCond::COUNT_)>;
   using PostScripts = std::array<ScriptFunction, size_t(PostCond::COUNT_)>;
 
+  /// The scripts executed by executeTick(). Nodes without scripts skip
+  /// them entirely: modify them before the next tick, not asynchronously.
   PreScripts& preConditionsScripts();
   PostScripts& postConditionsScripts();
 
 private:
+  template <typename T>
+  friend class InputPortHandle;
+
+  template <typename T>
+  friend class OutputPortHandle;
 
   struct PImpl;
   std::unique_ptr<PImpl> _p;
 
+  // convertFromString<T>, with the special case of enums registered in the factory
+  template <typename T>
+  T parseString(const std::string& str) const;
+
+  // A value converted from a string by getInput(), stored to avoid
+  // parsing the same string again at the next tick.
+  struct ParsedInput
+  {
+    std::string source;
+    std::type_index type = typeid(void);
+    std::shared_ptr<void> value;
+  };
+
+  // The ParsedInput of a port. Lock parsedInputMutex() to access it.
+  ParsedInput& parsedInput(const std::string& key) const;
+  std::mutex& parsedInputMutex() const;
+
+  // A literal input port (or a default value of the manifest), converted
+  // in the constructor with the type declared in the manifest.
+  struct LiteralInput
+  {
+    // the string in NodeConfig::input_ports, or the PortInfo of the default value
+    const void* port = nullptr;
+    std::string source;
+    Any value;
+  };
+
+  // A port remapped to a blackboard entry, with the key already interned
+  struct RemappedPort
+  {
+    // the string in NodeConfig::input_ports (output_ports), or the PortInfo
+    const void* port = nullptr;
+    std::string source;
+    Blackboard::KeyID key = SymbolTable::InvalidID;
+  };
+
+  // Convert the literal input ports and intern the keys of the remapped ones.
+  // Called by the constructor, or after the NodeConfig was injected by Instantiate()
+  void resolvePorts();
+
+  // The LiteralInput of a port, nullptr if it wasn't converted in the constructor.
+  // They are never modified afterward, so no locking is needed.
+  const LiteralInput* literalInput(const void* port) const;
+
+  // The KeyID of a remapped port, or SymbolTable::InvalidID
+  // if its string (source) changed after the constructor.
+  Blackboard::KeyID remappedKeyID(const void* port, StringView source) const;
+
+  // Same as parseString<T>(str), but the result is reused until
+  // the string of that port changes.
+  template <typename T>
+  T parseStringCached(const std::string& key, StringView str) const;
+
+  // executeTick(), when there are scripts or callbacks
+  NodeStatus executeTickWithHooks(bool has_callbacks);
+
   Expected<NodeStatus> checkPreConditions();
   void checkPostConditions(NodeStatus status);
 
+  void notifyStatusChange(NodeStatus prev_status, NodeStatus new_status,
+                          bool has_waiters);
+
   /// The method used to interrupt the execution of a RUNNING node.
   /// Only Async nodes that may return RUNNING should implement it.
   virtual void halt() = 0;
@@ -372,36 +511,87 @@ private:
 
 //-------------------------------------------------------
 template <typename T>
-inline Result TreeNode::getInput(const std::string& key, T& destination) const
+inline T TreeNode::parseString(const std::string& str) const
 {
   // address the special case where T is an enum
-  auto ParseString = [this](const std::string& str) -> T
+  if constexpr (std::is_enum_v<T> && !std::is_same_v<T, NodeStatus>)
   {
-    (void)this; // maybe unused
-    if constexpr (std::is_enum_v<T> && !std::is_same_v<T, NodeStatus>)
+    auto it = config().enums->find(str);
+    // conversion available
+    if( it != config().enums->end() )
     {
-      auto it = config().enums->find(str);
-      // conversion available
-      if( it != config().enums->end() )
-      {
-        return static_cast<T>(it->second);
-      }
-      else {
-        // hopefully str contains a number that can be parsed. May throw
-        return static_cast<T>(convertFromString<int>(str));
-      }
+      return static_cast<T>(it->second);
     }
     else {
-      return convertFromString<T>(str);
+      // hopefully str contains a number that can be parsed. May throw
+      return static_cast<T>(convertFromString<int>(str));
     }
-  };
+  }
+  else {
+    return convertFromString<T>(str);
+  }
+}
+
+template <typename T>
+inline T TreeNode::parseStringCached(const std::string& key, StringView str) const
+{
+  // not worth it, or not possible
+  if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, StringView> ||
+                std::is_same_v<T, Any> || !std::is_copy_constructible_v<T>)
+  {
+    return parseString<T>(std::string(str));
+  }
+  else
+  {
+    std::unique_lock lk(parsedInputMutex());
+    if (const auto& parsed = parsedInput(key); parsed.type == typeid(T) && parsed.source == str)
+    {
+      return *static_cast<const T*>(parsed.value.get());
+    }
+    lk.unlock();
 
-  std::string port_value_str;
+    // this may throw
+    T value = parseString<T>(std::string(str));
+
+    lk.lock();
+    auto& parsed = parsedInput(key);
+    parsed.source = str;
+    if (parsed.type == typeid(T))
+    {
+      // reuse the allocation
+      *static_cast<T*>(parsed.value.get()) = value;
+    }
+    else
+    {
+      parsed.type = typeid(T);
+      parsed.value = std::make_shared<T>(value);
+    }
+    return value;
+  }
+}
+
+template <typename T>
+inline Result TreeNode::getInput(const std::string& key, T& destination) const
+{
+  // avoid copying the string of the port, if possible
+  const std::string* port_value_ptr = nullptr;
+  std::string default_value_str;
+  // the string in input_ports or the PortInfo, used to find what was
+  // resolved in the constructor
+  const void* port = nullptr;
+  const LiteralInput* literal = nullptr;
 
   auto input_port_it = config().input_ports.find(key);
   if(input_port_it != config().input_ports.end())
   {
-    port_value_str = input_port_it->second;
+    port_value_ptr = &input_port_it->second;
+    port = port_value_ptr;
+    literal = literalInput(port);
+    // the port might have been modified after the constructor
+    if(literal && literal->source != *port_value_ptr)
+    {
+      literal = nullptr;
+    }
   }
   else
   {
@@ -425,7 +615,17 @@ inline Result TreeNode::getInput(const std::string& key, T& destination) const
     }
     if(port_info.defaultValue().isString())
     {
-      port_value_str = port_info.defaultValue().cast<std::string>();
+      port = &port_info;
+      literal = literalInput(port);
+      if(literal)
+      {
+        port_value_ptr = &literal->source;
+      }
+      else
+      {
+        default_value_str = port_info.defaultValue().cast<std::string>();
+        port_value_ptr = &default_value_str;
+      }
     }
     else
     {
@@ -433,24 +633,38 @@ inline Result TreeNode::getInput(const std::string& key, T& destination) const
       return {};
     }
   }
+  const std::string& port_value_str = *port_value_ptr;
 
-  auto remapped_res = getRemappedKey(key, port_value_str);
+  StringView remapped_key;
+  const bool is_remapped = !literal && getRemappedKey(key, port_value_str, remapped_key);
   try
   {
     // pure string, not a blackboard key
-    if (!remapped_res)
+    if (!is_remapped)
     {
-      destination = ParseString(port_value_str);
+      if constexpr (!std::is_same_v<T, Any> && std::is_copy_constructible_v<T>)
+      {
+        if (literal && literal->value.type() == typeid(T))
+        {
+          destination = literal->value.template cast<T>();
+          return {};
+        }
+      }
+      destination = parseStringCached<T>(key, port_value_str);
       return {};
     }
-    const auto& remapped_key = remapped_res.value();
 
     if (!config().blackboard)
     {
       return nonstd::make_unexpected("getInput(): trying to access an invalid Blackboard");
     }
 
-    if (auto any_ref = config().blackboard->getAnyLocked(std::string(remapped_key)))
+    // skip the lookup of the key in the SymbolTable, if possible
+    const auto key_id = remappedKeyID(port, port_value_str);
+    auto any_ref = (key_id != SymbolTable::InvalidID) ?
+                       config().blackboard->getAnyLocked(key_id) :
+                       config().blackboard->getAnyLocked(remapped_key);
+    if (any_ref)
     {
       auto val = any_ref.get();
       // support getInput<Any>()
@@ -464,7 +678,9 @@ inline Result TreeNode::getInput(const std::string& key, T& destination) const
       {
         if (!std::is_same_v<T, std::string> && val->isString())
         {
-          destination = ParseString(val->cast<std::string>());
+          // parsed again only if the entry changed
+          const auto str = val->template castPtr<SafeAny::SimpleString>();
+          destination = parseStringCached<T>(key, str->toStdStringView());
         }
         else
         {
@@ -504,29 +720,306 @@ inline Result TreeNode::setOutput(const std::string& key, const T& value)
   StringView remapped_key = remap_it->second;
   if (remapped_key == "{=}" || remapped_key == "=")
   {
-    config().blackboard->set(static_cast<std::string>(key), value);
-    return {};
+    remapped_key = key;
+  }
+  else
+  {
+    if (!isBlackboardPointer(remapped_key))
+    {
+      return nonstd::make_unexpected("setOutput requires a blackboard pointer. Use {}");
+    }
+
+    if constexpr(std::is_same_v<BT::Any, T>)
+    {
+      if(config().manifest->ports.at(key).type() != typeid(BT::Any))
+      {
+        throw LogicError("setOutput<Any> is not allowed, unless the port "
+                         "was declared using OutputPort<Any>");
+      }
+    }
+    remapped_key = stripBlackboardPointer(remapped_key);
   }
 
-  if (!isBlackboardPointer(remapped_key))
+  // skip the lookup of the key in the SymbolTable, if possible
+  if (const auto key_id = remappedKeyID(&remap_it->second, remap_it->second);
+      key_id != SymbolTable::InvalidID)
+  {
+    config().blackboard->set(key_id, value);
+  }
+  else
   {
-    return nonstd::make_unexpected("setOutput requires a blackboard pointer. Use {}");
+    config().blackboard->set(remapped_key, value);
   }
+  return {};
+}
 
-  if constexpr(std::is_same_v<BT::Any, T>)
+/**
+ * @brief InputPortHandle is a faster alternative to TreeNode::getInput(),
+ * to be used in nodes that read the same port at every tick.
+ *
+ * The port is resolved only once (the first time get() is called):
+ * the remapping and the lookup of the blackboard entry by name are skipped
+ * afterward, and reading the value costs one lock of the entry's mutex
+ * (or none, if the entry uses Blackboard::enableLockFreeRead()).
+ *
+ * Example:
+ *
+ *    class MyAction : public SyncActionNode
+ *    {
+ *      InputPortHandle<double> speed_;
+ *    public:
+ *      MyAction(const std::string& name, const NodeConfig& config):
+ *        SyncActionNode(name, config), speed_(*this, "speed") {}
+ *
+ *      NodeStatus tick() override {
+ *        double speed = 0;
+ *        if(!speed_.get(speed)) { return NodeStatus::FAILURE; }
+ *        ...
+ *      }
+ *    };
+ *
+ * NOTE: if the entry is removed with Blackboard::unset(), the handle will
+ * keep reading the removed one. Call reset() to resolve the port again.
+ */
+template <typename T>
+class InputPortHandle
+{
+public:
+  InputPortHandle(const TreeNode& node, std::string key) :
+    node_(&node), key_(std::move(key))
+  {}
+
+  /// Same as TreeNode::getInput(key, destination)
+  Result get(T& destination) const
   {
-    if(config().manifest->ports.at(key).type() != typeid(BT::Any))
+    if (!bound_)
     {
-      throw LogicError("setOutput<Any> is not allowed, unless the port "
-                       "was declared using OutputPort<Any>");
+      if (auto res = bind(); !res)
+      {
+        return res;
+      }
+    }
+    try
+    {
+      if (!entry_)
+      {
+        // literal value: parse it only once
+        if (!literal_value_)
+        {
+          literal_value_ = node_->template parseString<T>(literal_str_);
+        }
+        destination = *literal_value_;
+        return {};
+      }
+
+      // entries using Blackboard::enableLockFreeRead() don't need the mutex
+      if (Blackboard::getLockFree(*entry_, destination))
+      {
+        return {};
+      }
+
+      std::scoped_lock lk(entry_->entry_mutex);
+      const Any& val = entry_->value;
+      // support InputPortHandle<Any>
+      if constexpr (std::is_same_v<T, Any>)
+      {
+        destination = val;
+        return {};
+      }
+      if (!val.empty())
+      {
+        if (!std::is_same_v<T, std::string> && val.isString())
+        {
+          destination = node_->template parseString<T>(val.cast<std::string>());
+        }
+        else
+        {
+          destination = val.cast<T>();
+        }
+        return {};
+      }
     }
+    catch (std::exception& err)
+    {
+      return nonstd::make_unexpected(err.what());
+    }
+    return nonstd::make_unexpected(StrCat("InputPortHandle::get() failed because the "
+                                          "entry [", remapped_key_, "] is empty"));
   }
 
-  remapped_key = stripBlackboardPointer(remapped_key);
-  config().blackboard->set(static_cast<std::string>(remapped_key), value);
+  /// Same as TreeNode::getInput<T>(key)
+  [[nodiscard]] Expected<T> get() const
+  {
+    T out;
+    auto res = get(out);
+    return (res) ? Expected<T>(out) : nonstd::make_unexpected(res.error());
+  }
 
-  return {};
-}
+  const std::string& key() const
+  {
+    return key_;
+  }
+
+  /// Forget the resolved port. It will be resolved again by the next get()
+  void reset()
+  {
+    bound_ = false;
+    entry_.reset();
+    literal_value_.reset();
+  }
+
+private:
+  const TreeNode* node_;
+  std::string key_;
+
+  mutable bool bound_ = false;
+  mutable std::shared_ptr<Blackboard::Entry> entry_;
+  mutable std::string remapped_key_;
+  mutable std::string literal_str_;
+  mutable std::optional<T> literal_value_;
+
+  Result bind() const
+  {
+    const auto& config = node_->config();
+    auto port_it = config.input_ports.find(key_);
+    if (port_it != config.input_ports.end())
+    {
+      literal_str_ = port_it->second;
+    }
+    else
+    {
+      auto port_manifest_it = config.manifest->ports.find(key_);
+      if (port_manifest_it == config.manifest->ports.end() ||
+          port_manifest_it->second.defaultValue().empty())
+      {
+        return nonstd::make_unexpected(
+            StrCat("InputPortHandle of node '", node_->fullPath(),
+                   "' failed because nor the manifest or the XML contain "
+                   "the key: [", key_, "]"));
+      }
+      const auto& default_value = port_manifest_it->second.defaultValue();
+      if (!default_value.isString())
+      {
+        literal_value_ = default_value.cast<T>();
+        bound_ = true;
+        return {};
+      }
+      literal_str_ = default_value.cast<std::string>();
+    }
+
+    if (auto remapped_res = TreeNode::getRemappedKey(key_, literal_str_))
+    {
+      if (!config.blackboard)
+      {
+        return nonstd::make_unexpected("InputPortHandle: trying to access an invalid Blackboard");
+      }
+      remapped_key_ = std::string(remapped_res.value());
+      entry_ = config.blackboard->getEntry(remapped_key_);
+      if (!entry_)
+      {
+        // the entry may be created later. Try again next time
+        return nonstd::make_unexpected(StrCat("InputPortHandle::get() failed because it "
+                                              "was unable to find the key [", key_,
+                                              "] remapped to [", remapped_key_, "]"));
+      }
+    }
+    bound_ = true;
+    return {};
+  }
+};
+
+/**
+ * @brief OutputPortHandle is a faster alternative to TreeNode::setOutput(),
+ * to be used in nodes that write the same port at every tick.
+ *
+ * Like InputPortHandle, the port is resolved only once and the value is
+ * written directly into the blackboard entry, with the same type checking
+ * of Blackboard::set().
+ */
+template <typename T>
+class OutputPortHandle
+{
+public:
+  OutputPortHandle(TreeNode& node, std::string key) : node_(&node), key_(std::move(key))
+  {}
+
+  /// Same as TreeNode::setOutput(key, value)
+  Result set(const T& value)
+  {
+    if (!bound_)
+    {
+      if (auto res = bind(); !res)
+      {
+        return res;
+      }
+    }
+    auto& blackboard = node_->config().blackboard;
+    if (!entry_)
+    {
+      // first write: the entry is created by the blackboard
+      blackboard->set(remapped_key_, value);
+      entry_ = blackboard->getEntry(remapped_key_);
+      return {};
+    }
+    blackboard->setEntry(remapped_key_, *entry_, value);
+    return {};
+  }
+
+  const std::string& key() const
+  {
+    return key_;
+  }
+
+  /// Forget the resolved port. It will be resolved again by the next set()
+  void reset()
+  {
+    bound_ = false;
+    entry_.reset();
+  }
+
+private:
+  TreeNode* node_;
+  std::string key_;
+
+  bool bound_ = false;
+  std::shared_ptr<Blackboard::Entry> entry_;
+  std::string remapped_key_;
+
+  Result bind()
+  {
+    const auto& config = node_->config();
+    if (!config.blackboard)
+    {
+      return nonstd::make_unexpected("OutputPortHandle: trying to access a "
+                                     "Blackboard(BB) entry, but BB is invalid");
+    }
+    auto remap_it = config.output_ports.find(key_);
+    if (remap_it == config.output_ports.end())
+    {
+      return nonstd::make_unexpected(StrCat("OutputPortHandle: "
+                                            "NodeConfig::output_ports "
+                                            "does not contain the key: [",
+                                            key_, "]"));
+    }
+    auto remapped_res = TreeNode::getRemappedKey(key_, remap_it->second);
+    if (!remapped_res)
+    {
+      return nonstd::make_unexpected("OutputPortHandle requires a blackboard pointer. Use {}");
+    }
+    if constexpr(std::is_same_v<BT::Any, T>)
+    {
+      if(config.manifest->ports.at(key_).type() != typeid(BT::Any))
+      {
+        throw LogicError("OutputPortHandle<Any> is not allowed, unless the port "
+                         "was declared using OutputPort<Any>");
+      }
+    }
+    remapped_key_ = std::string(remapped_res.value());
+    entry_ = config.blackboard->getEntry(remapped_key_);
+    bound_ = true;
+    return {};
+  }
+};
 
 // Utility function to fill the list of ports using T::providedPorts();
 template <typename T>
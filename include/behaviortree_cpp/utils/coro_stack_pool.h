@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace BT
+{
+
+/**
+ * @brief CoroStackPool recycles the memory (stack included) of the coroutines
+ * used by CoroActionNode, that would otherwise be allocated and released
+ * every time the action is started and completed (or halted).
+ *
+ * Each Tree created by the BehaviorTreeFactory owns a pool;
+ * the memory is released when the tree is destroyed.
+ *
+ * See BehaviorTreeFactory::setCoroStackPoolOptions().
+ */
+class CoroStackPool
+{
+public:
+  struct Options
+  {
+    /// Stack size used by the node types not listed in stack_sizes.
+    /// If 0, the default of minicoro (56 KB) is used.
+    size_t default_stack_size = 0;
+
+    /// Stack size of specific node types, by registration ID.
+    std::unordered_map<std::string, size_t> stack_sizes;
+
+    /// Measure the maximum stack usage of each node type. The stacks are
+    /// filled with a known pattern, that is scanned when the coroutine is
+    /// destroyed: this has a cost proportional to the stack size.
+    bool measure_stack_usage = false;
+  };
+
+  struct Stats
+  {
+    /// Blocks allocated from the heap.
+    size_t allocated_blocks = 0;
+    /// Allocations served reusing a block of the pool.
+    size_t reused_blocks = 0;
+    /// Blocks currently available in the pool, and their size in bytes.
+    size_t cached_blocks = 0;
+    size_t cached_bytes = 0;
+    /// Maximum stack usage (bytes) of each node type, by registration ID.
+    /// Empty if Options::measure_stack_usage is false.
+    std::unordered_map<std::string, size_t> stack_high_water;
+  };
+
+  CoroStackPool();
+
+  explicit CoroStackPool(Options options);
+
+  CoroStackPool(const CoroStackPool&) = delete;
+  CoroStackPool& operator=(const CoroStackPool&) = delete;
+
+  ~CoroStackPool();
+
+  /// Stack size of a node type (0 means "default of minicoro").
+  [[nodiscard]] size_t stackSize(const std::string& registration_ID) const;
+
+  /// Memory block of at least `size` bytes, aligned to alignof(std::max_align_t).
+  [[nodiscard]] void* allocate(size_t size);
+
+  /// Give back a block obtained with allocate().
+  void deallocate(void* ptr);
+
+  /**
+   * @brief recordStackUsage updates the high-water mark of a node type and
+   * restores the pattern on the used part of the stack.
+   * It does nothing if Options::measure_stack_usage is false.
+   */
+  void recordStackUsage(const std::string& registration_ID, void* stack_base,
+                        size_t stack_size);
+
+  [[nodiscard]] Stats stats() const;
+
+  [[nodiscard]] const Options& options() const
+  {
+    return options_;
+  }
+
+private:
+  const Options options_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<size_t, std::vector<void*>> free_blocks_;
+  Stats stats_;
+};
+
+}   // namespace BT
@@ -0,0 +1,108 @@
+#ifndef BEHAVIORTREECORE_NODE_ARENA_HPP
+#define BEHAVIORTREECORE_NODE_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace BT
+{
+
+/**
+ * @brief NodeArena is a monotonic allocator used to store all the TreeNodes
+ * of a Tree (and their private implementation) in a few contiguous blocks
+ * of memory.
+ *
+ * Since the tree is created depth-first, the nodes are stored in the same
+ * order they are visited when the tree is ticked.
+ * Memory is never released individually: it is released all at once,
+ * when the arena is destroyed.
+ *
+ * TreeNode uses the arena made current with NodeArena::Scope, if any.
+ * The arena must be owned by a std::shared_ptr, that the nodes will share.
+ * See BehaviorTreeFactory::enableNodeArena().
+ */
+class NodeArena : public std::enable_shared_from_this<NodeArena>
+{
+public:
+  static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+  explicit NodeArena(size_t block_size = DefaultBlockSize) : block_size_(block_size)
+  {}
+
+  NodeArena(const NodeArena&) = delete;
+  NodeArena& operator=(const NodeArena&) = delete;
+
+  /// Allocation aligned to alignof(std::max_align_t)
+  void* allocate(size_t size)
+  {
+    constexpr size_t align = alignof(std::max_align_t);
+    size = (size + align - 1) & ~(align - 1);
+
+    if (blocks_.empty() || offset_ + size > current_size_)
+    {
+      const size_t new_size = std::max(size, block_size_);
+      blocks_.emplace_back(new std::max_align_t[new_size / sizeof(std::max_align_t) + 1]);
+      current_size_ = new_size;
+      offset_ = 0;
+    }
+    auto ptr = reinterpret_cast<std::byte*>(blocks_.back().get()) + offset_;
+    offset_ += size;
+    allocated_bytes_ += size;
+    return ptr;
+  }
+
+  /// Total memory given to the nodes, in bytes
+  size_t allocatedBytes() const
+  {
+    return allocated_bytes_;
+  }
+
+  size_t blocksCount() const
+  {
+    return blocks_.size();
+  }
+
+  /// The arena used by the current thread (nullptr by default)
+  static NodeArena* current()
+  {
+    return currentRef();
+  }
+
+  /// RAII object that makes an arena current, in this thread.
+  class Scope
+  {
+  public:
+    explicit Scope(NodeArena* arena) : prev_(currentRef())
+    {
+      currentRef() = arena;
+    }
+    ~Scope()
+    {
+      currentRef() = prev_;
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    NodeArena* prev_;
+  };
+
+private:
+  static NodeArena*& currentRef()
+  {
+    static thread_local NodeArena* arena = nullptr;
+    return arena;
+  }
+
+  size_t block_size_;
+  std::vector<std::unique_ptr<std::max_align_t[]>> blocks_;
+  size_t current_size_ = 0;
+  size_t offset_ = 0;
+  size_t allocated_bytes_ = 0;
+};
+
+}   // namespace BT
+
+#endif   // BEHAVIORTREECORE_NODE_ARENA_HPP
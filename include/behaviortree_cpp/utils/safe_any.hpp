@@ -16,6 +16,7 @@
 #include <charconv>
 #endif
 
+#include <cstdint>
 #include <string>
 #include <type_traits>
 #include <typeindex>
@@ -60,6 +61,43 @@ class Any
   template <typename T>
   nonstd::expected<T, std::string> stringToNumber() const;
 
+  // Tag of the type stored internally, to avoid comparing std::type_info
+  // in the conversions between numbers and strings.
+  enum class Kind : uint8_t
+  {
+    EMPTY,
+    INT64,
+    UINT64,
+    DOUBLE,
+    STRING,
+    OTHER
+  };
+
+  template <typename T>
+  static constexpr Kind kindOf()
+  {
+    if constexpr (std::is_same_v<T, int64_t>)
+    {
+      return Kind::INT64;
+    }
+    else if constexpr (std::is_same_v<T, uint64_t>)
+    {
+      return Kind::UINT64;
+    }
+    else if constexpr (std::is_same_v<T, double>)
+    {
+      return Kind::DOUBLE;
+    }
+    else if constexpr (std::is_same_v<T, SafeAny::SimpleString>)
+    {
+      return Kind::STRING;
+    }
+    else
+    {
+      return Kind::OTHER;
+    }
+  }
+
 public:
 
 
@@ -69,45 +107,46 @@ public:
 
   ~Any() = default;
 
-  Any(const Any& other) : _any(other._any), _original_type( other._original_type )
+  Any(const Any& other) : _any(other._any), _original_type( other._original_type ), _kind(other._kind)
   {
   }
 
-  Any(Any&& other) : _any( std::move(other._any) ), _original_type( other._original_type )
+  Any(Any&& other) : _any( std::move(other._any) ), _original_type( other._original_type ), _kind(other._kind)
   {
+    other._kind = Kind::EMPTY;
   }
 
-  explicit Any(const double& value) : _any(value), _original_type( typeid(double) )
+  explicit Any(const double& value) : _any(value), _original_type( typeid(double) ), _kind(Kind::DOUBLE)
   {
   }
 
-  explicit Any(const uint64_t& value) : _any(value), _original_type( typeid(uint64_t) )
+  explicit Any(const uint64_t& value) : _any(value), _original_type( typeid(uint64_t) ), _kind(Kind::UINT64)
   {
   }
 
-  explicit Any(const float& value) : _any(double(value)), _original_type( typeid(float) )
+  explicit Any(const float& value) : _any(double(value)), _original_type( typeid(float) ), _kind(Kind::DOUBLE)
   {
   }
 
-  explicit Any(const std::string& str) : _any(SafeAny::SimpleString(str)), _original_type( typeid(std::string) )
+  explicit Any(const std::string& str) : _any(SafeAny::SimpleString(str)), _original_type( typeid(std::string) ), _kind(Kind::STRING)
   {
   }
 
-  explicit Any(const char* str) : _any(SafeAny::SimpleString(str)), _original_type( typeid(std::string) )
+  explicit Any(const char* str) : _any(SafeAny::SimpleString(str)), _original_type( typeid(std::string) ), _kind(Kind::STRING)
   {
   }
 
-  explicit Any(const SafeAny::SimpleString& str) : _any(str), _original_type( typeid(std::string) )
+  explicit Any(const SafeAny::SimpleString& str) : _any(str), _original_type( typeid(std::string) ), _kind(Kind::STRING)
   {
   }
 
-  explicit Any(const std::string_view& str) : _any(SafeAny::SimpleString(str)), _original_type( typeid(std::string) )
+  explicit Any(const std::string_view& str) : _any(SafeAny::SimpleString(str)), _original_type( typeid(std::string) ), _kind(Kind::STRING)
   {
   }
 
   // all the other integrals are casted to int64_t
   template <typename T>
-  explicit Any(const T& value, EnableIntegral<T> = 0) : _any(int64_t(value)), _original_type( typeid(T) )
+  explicit Any(const T& value, EnableIntegral<T> = 0) : _any(int64_t(value)), _original_type( typeid(T) ), _kind(Kind::INT64)
   {
   }
 
@@ -117,11 +156,20 @@ public:
 
   // default for other custom types
   template <typename T>
-  explicit Any(const T& value, EnableNonIntegral<T> = 0) : _any(value), _original_type( typeid(T) )
+  explicit Any(const T& value, EnableNonIntegral<T> = 0) : _any(value), _original_type( typeid(T) ), _kind(kindOf<T>())
   {
     static_assert(!std::is_reference<T>::value, "Any can not contain references");
   }
 
+  /// Values of type T are stored without heap allocations if their size
+  /// is up to ANY_IMPL_STACK_SIZE bytes (see the CMake option BTCPP_ANY_INLINE_SIZE)
+  /// and their move constructor is noexcept.
+  template <typename T>
+  static constexpr bool isStoredInline()
+  {
+    return linb::any::is_stored_inline<T>();
+  }
+
   Any& operator = (const Any& other);
 
   [[nodiscard]] bool isNumber() const;
@@ -130,7 +178,7 @@ public:
 
   [[nodiscard]] bool isString() const
   {
-    return _any.type() == typeid(SafeAny::SimpleString);
+    return _kind == Kind::STRING;
   }
 
   // check is the original type is equal to T
@@ -141,7 +189,7 @@ public:
   }
 
   // copy the value (casting into dst). We preserve the destination type.
-  void copyInto(Any& dst);
+  void copyInto(Any& dst) const;
 
   // this is different from any_cast, because if allows safe
   // conversions between arithmetic values and from/to string.
@@ -177,6 +225,11 @@ public:
     return _any.empty() ? nullptr : linb::any_cast<T>(&_any);
   }
 
+  template <typename T>
+  [[nodiscard]] const T* castPtr() const {
+    return const_cast<Any*>(this)->castPtr<T>();
+  }
+
   // This is the original type
   [[nodiscard]] const std::type_index& type() const noexcept
   {
@@ -197,6 +250,14 @@ public:
 private:
   linb::any _any;
   std::type_index _original_type;
+  Kind _kind = Kind::EMPTY;
+
+  // the caller must check the kind first
+  template <typename T>
+  const T& uncheckedCast() const
+  {
+    return *_any.unchecked_cast<T>();
+  }
 
   //----------------------------
 
@@ -279,23 +340,21 @@ inline Any &Any::operator =(const Any &other)
 {
   this->_any = other._any;
   this->_original_type = other._original_type;
+  this->_kind = other._kind;
   return *this;
 }
 
 inline bool Any::isNumber() const
 {
-  return _any.type() == typeid(int64_t) ||
-         _any.type() == typeid(uint64_t) ||
-         _any.type() == typeid(double);
+  return _kind == Kind::INT64 || _kind == Kind::UINT64 || _kind == Kind::DOUBLE;
 }
 
 inline bool Any::isIntegral() const
 {
-  return _any.type() == typeid(int64_t) ||
-         _any.type() == typeid(uint64_t);
+  return _kind == Kind::INT64 || _kind == Kind::UINT64;
 }
 
-inline void Any::copyInto(Any &dst)
+inline void Any::copyInto(Any &dst) const
 {
   if(dst.empty())
   {
@@ -303,28 +362,25 @@ inline void Any::copyInto(Any &dst)
     return;
   }
 
-  const auto& dst_type = dst.castedType();
-
-  if ((castedType() == dst_type) || (isString() && dst.isString()) )
+  if (_kind == dst._kind && (_kind != Kind::OTHER || castedType() == dst.castedType()))
   {
     dst._any = _any;
   }
   else if(isNumber() && dst.isNumber())
   {
-    if (dst_type == typeid(int64_t))
-    {
-      dst._any = cast<int64_t>();
-    }
-    else if (dst_type == typeid(uint64_t))
-    {
-      dst._any = cast<uint64_t>();
-    }
-    else if (dst_type == typeid(double))
+    switch (dst._kind)
     {
-      dst._any = cast<double>();
-    }
-    else{
-      throw std::runtime_error("Any::copyInto fails");
+      case Kind::INT64:
+        dst._any = cast<int64_t>();
+        break;
+      case Kind::UINT64:
+        dst._any = cast<uint64_t>();
+        break;
+      case Kind::DOUBLE:
+        dst._any = cast<double>();
+        break;
+      default:
+        throw std::runtime_error("Any::copyInto fails");
     }
   }
   else{
@@ -335,26 +391,19 @@ inline void Any::copyInto(Any &dst)
 template<typename DST> inline
 nonstd::expected<DST, std::string> Any::convert(EnableString<DST>) const
 {
-  const auto& type = _any.type();
-
-  if (type == typeid(SafeAny::SimpleString))
-  {
-    return linb::any_cast<SafeAny::SimpleString>(_any).toStdString();
-  }
-  else if (type == typeid(int64_t))
-  {
-    return std::to_string(linb::any_cast<int64_t>(_any));
+  switch (_kind)
+  {
+    case Kind::STRING:
+      return uncheckedCast<SafeAny::SimpleString>().toStdString();
+    case Kind::INT64:
+      return std::to_string(uncheckedCast<int64_t>());
+    case Kind::UINT64:
+      return std::to_string(uncheckedCast<uint64_t>());
+    case Kind::DOUBLE:
+      return std::to_string(uncheckedCast<double>());
+    default:
+      return nonstd::make_unexpected( errorMsg<DST>() );
   }
-  else if (type == typeid(uint64_t))
-  {
-    return std::to_string(linb::any_cast<uint64_t>(_any));
-  }
-  else if (type == typeid(double))
-  {
-    return std::to_string(linb::any_cast<double>(_any));
-  }
-
-  return nonstd::make_unexpected( errorMsg<DST>() );
 }
 
 template<typename T> inline
@@ -362,7 +411,7 @@ nonstd::expected<T, std::string> Any::stringToNumber() const
 {
   static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "Expecting a numeric type");
 
-  const auto str = linb::any_cast<SafeAny::SimpleString>(_any);
+  const auto& str = uncheckedCast<SafeAny::SimpleString>();
 #if __cpp_lib_to_chars >= 201611L
   T out;
   auto [ptr, err] = std::from_chars(str.data(), str.data() + str.size(), out);
@@ -402,20 +451,15 @@ nonstd::expected<DST, std::string> Any::convert(EnableEnum<DST>) const
 {
   using SafeAny::details::convertNumber;
 
-  const auto& type = _any.type();
-
-  if (type == typeid(int64_t))
+  switch (_kind)
   {
-    auto out = linb::any_cast<int64_t>(_any);
-    return static_cast<DST>(out);
+    case Kind::INT64:
+      return static_cast<DST>(uncheckedCast<int64_t>());
+    case Kind::UINT64:
+      return static_cast<DST>(uncheckedCast<uint64_t>());
+    default:
+      return nonstd::make_unexpected( errorMsg<DST>() );
   }
-  else if (type == typeid(uint64_t))
-  {
-    auto out = linb::any_cast<uint64_t>(_any);
-    return static_cast<DST>(out);
-  }
-
-  return nonstd::make_unexpected( errorMsg<DST>() );
 }
 
 template<typename DST> inline
@@ -424,22 +468,19 @@ nonstd::expected<DST, std::string> Any::convert(EnableArithmetic<DST>) const
   using SafeAny::details::convertNumber;
   DST out;
 
-  const auto& type = _any.type();
-
-  if (type == typeid(int64_t))
-  {
-    convertNumber<int64_t, DST>(linb::any_cast<int64_t>(_any), out);
-  }
-  else if (type == typeid(uint64_t))
-  {
-    convertNumber<uint64_t, DST>(linb::any_cast<uint64_t>(_any), out);
-  }
-  else if (type == typeid(double))
+  switch (_kind)
   {
-    convertNumber<double, DST>(linb::any_cast<double>(_any), out);
-  }
-  else{
-    return nonstd::make_unexpected( errorMsg<DST>() );
+    case Kind::INT64:
+      convertNumber<int64_t, DST>(uncheckedCast<int64_t>(), out);
+      break;
+    case Kind::UINT64:
+      convertNumber<uint64_t, DST>(uncheckedCast<uint64_t>(), out);
+      break;
+    case Kind::DOUBLE:
+      convertNumber<double, DST>(uncheckedCast<double>(), out);
+      break;
+    default:
+      return nonstd::make_unexpected( errorMsg<DST>() );
   }
   return out;
 }
@@ -455,7 +496,15 @@ nonstd::expected<T, std::string> Any::tryCast() const
     throw std::runtime_error("Any::cast failed because it is empty");
   }
 
-  if (castedType() == typeid(T))
+  // fast path, without comparing std::type_info
+  if constexpr (kindOf<T>() != Kind::OTHER)
+  {
+    if (_kind == kindOf<T>())
+    {
+      return uncheckedCast<T>();
+    }
+  }
+  else if (castedType() == typeid(T))
   {
     return linb::any_cast<T>(_any);
   }
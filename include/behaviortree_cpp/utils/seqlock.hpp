@@ -0,0 +1,82 @@
+#ifndef BEHAVIORTREECORE_SEQLOCK_HPP
+#define BEHAVIORTREECORE_SEQLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace BT
+{
+
+/**
+ * @brief SeqLock stores a small trivially copyable value (up to 16 bytes)
+ * that can be read without locking any mutex.
+ *
+ * Readers never block the writer: they retry if a write happened while
+ * they were copying the value.
+ * There must be only one writer at a time; concurrent writers must be
+ * serialized by the caller.
+ */
+class SeqLock
+{
+public:
+  static constexpr size_t Capacity = 2 * sizeof(uint64_t);
+
+  template <typename T>
+  static constexpr bool IsSupported()
+  {
+    return std::is_trivially_copyable_v<T> && sizeof(T) <= Capacity;
+  }
+
+  template <typename T>
+  void store(const T& value)
+  {
+    static_assert(IsSupported<T>(), "SeqLock requires a trivially copyable type, "
+                                    "with size up to 16 bytes");
+    uint64_t buffer[2] = {0, 0};
+    std::memcpy(buffer, &value, sizeof(T));
+
+    const auto seq = seq_.load(std::memory_order_relaxed);
+    // odd sequence: write in progress
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    words_[0].store(buffer[0], std::memory_order_relaxed);
+    words_[1].store(buffer[1], std::memory_order_relaxed);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  /// Return false if store() was never called.
+  template <typename T>
+  bool load(T& value) const
+  {
+    static_assert(IsSupported<T>(), "SeqLock requires a trivially copyable type, "
+                                    "with size up to 16 bytes");
+    uint64_t buffer[2];
+    uint64_t seq_begin = 0;
+    uint64_t seq_end = 0;
+    do
+    {
+      seq_begin = seq_.load(std::memory_order_acquire);
+      buffer[0] = words_[0].load(std::memory_order_relaxed);
+      buffer[1] = words_[1].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      seq_end = seq_.load(std::memory_order_relaxed);
+    } while ((seq_begin & 1) != 0 || seq_begin != seq_end);
+
+    if (seq_begin == 0)
+    {
+      return false;
+    }
+    std::memcpy(&value, buffer, sizeof(T));
+    return true;
+  }
+
+private:
+  std::atomic<uint64_t> seq_ = 0;
+  std::atomic<uint64_t> words_[2] = {0, 0};
+};
+
+}   // namespace BT
+
+#endif   // BEHAVIORTREECORE_SEQLOCK_HPP
@@ -34,6 +34,13 @@ public:
     }
   }
 
+  /// True if nobody subscribed, or all the subscribers were notified
+  /// once after they expired.
+  bool empty() const
+  {
+    return subscribers_.empty();
+  }
+
   Subscriber subscribe(CallableFunction func)
   {
     Subscriber sub = std::make_shared<CallableFunction>(std::move(func));
@@ -33,12 +33,13 @@ class SimpleString {
     return *this;
   }
 
-  SimpleString(SimpleString&& other): SimpleString(nullptr, 0)
+  // noexcept: required by linb::any to store it in-place, without allocations
+  SimpleString(SimpleString&& other) noexcept : SimpleString(nullptr, 0)
   {
     std::swap(_storage, other._storage);
   }
 
-  SimpleString& operator=(SimpleString&& other)
+  SimpleString& operator=(SimpleString&& other) noexcept
   {
     this->~SimpleString();
 
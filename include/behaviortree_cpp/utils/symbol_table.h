@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace BT
+{
+
+/**
+ * @brief SymbolTable interns strings (the keys of the Blackboard): each
+ * distinct string is stored once and identified by a small integer ID.
+ *
+ * IDs are assigned in increasing order, starting from 0, and are never
+ * released; the views returned by str() are valid as long as the program runs.
+ * The memory used is therefore proportional to the number of distinct
+ * strings ever interned; find() never adds a string to the table.
+ *
+ * All the methods are thread-safe.
+ */
+class SymbolTable
+{
+public:
+  using ID = uint32_t;
+
+  static constexpr ID InvalidID = ~ID(0);
+
+  /// The table shared by all the blackboards.
+  static SymbolTable& global();
+
+  SymbolTable() = default;
+
+  SymbolTable(const SymbolTable&) = delete;
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+  /// Return the ID of the string, adding it to the table if necessary.
+  ID intern(std::string_view str);
+
+  /// Return the ID of the string, or InvalidID if it was never interned.
+  [[nodiscard]] ID find(std::string_view str) const;
+
+  /// The string with the given ID. Throws if the ID is not valid.
+  [[nodiscard]] std::string_view str(ID id) const;
+
+  [[nodiscard]] size_t size() const;
+
+private:
+  mutable std::shared_mutex mutex_;
+  // std::deque never moves its elements: the views are stable
+  std::deque<std::string> strings_;
+  std::unordered_map<std::string_view, ID> ids_;
+};
+
+}   // namespace BT
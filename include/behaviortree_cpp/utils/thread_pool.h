@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace BT
+{
+
+/**
+ * @brief Executor is the interface used to run tasks that may take a long
+ * time (for instance the tick() of a ThreadedAction) outside of the thread
+ * that ticks the tree.
+ *
+ * See BehaviorTreeFactory::setExecutor().
+ */
+class Executor
+{
+public:
+  using Task = std::function<void()>;
+
+  virtual ~Executor() = default;
+
+  /// Run the task asynchronously. It must not wait for the task to be completed.
+  virtual void execute(Task task) = 0;
+};
+
+/**
+ * @brief ThreadPool is the default Executor. Threads are created when needed,
+ * up to Options::max_threads, and are reused by the following tasks.
+ * The threads that stay idle longer than Options::idle_timeout are terminated.
+ *
+ * By default, the number of threads is not limited, like std::async.
+ * If a limit is set and all the threads are busy, new tasks wait in a queue:
+ * keep in mind that ThreadedActions running at the same time need one thread
+ * each, and that a queued ThreadedAction makes no progress.
+ */
+class ThreadPool : public Executor
+{
+public:
+  static constexpr size_t Unlimited = std::numeric_limits<size_t>::max();
+
+  static constexpr size_t DefaultMaxThreads = Unlimited;
+
+  struct Options
+  {
+    /// Maximum number of threads.
+    size_t max_threads = DefaultMaxThreads;
+
+    /// If not empty, the threads run only on these CPUs (Linux only).
+    std::vector<int> cpu_affinity;
+
+    /// If greater than 0, the threads use the real-time policy SCHED_FIFO
+    /// with this priority (Linux only; it requires the proper privileges).
+    int priority = 0;
+
+    /// Idle threads are terminated after this time (never, if zero).
+    std::chrono::milliseconds idle_timeout = std::chrono::seconds(10);
+  };
+
+  ThreadPool();
+
+  explicit ThreadPool(Options options);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// Wait until all the tasks in the queue are completed.
+  ~ThreadPool() override;
+
+  void execute(Task task) override;
+
+  /// Number of threads currently alive.
+  [[nodiscard]] size_t threadsCount() const;
+
+  [[nodiscard]] const Options& options() const
+  {
+    return options_;
+  }
+
+  /// The pool used when no Executor is specified. It is created when needed
+  /// and destroyed when the last user releases it.
+  static std::shared_ptr<ThreadPool> defaultPool();
+
+private:
+  using ThreadList = std::list<std::thread>;
+
+  void workerLoop(ThreadList::iterator self);
+
+  void configureThread();
+
+  // must be called with mutex_ locked
+  void joinFinishedThreads();
+
+  Options options_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Task> tasks_;
+  ThreadList threads_;
+  // threads terminated because of the idle_timeout, not joined yet
+  ThreadList finished_threads_;
+  size_t idle_threads_ = 0;
+  bool stop_ = false;
+};
+
+}   // namespace BT
@@ -5,6 +5,9 @@
 #include <condition_variable>
 #include <thread>
 #include <queue>
+#include <memory>
+#include <vector>
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <assert.h>
@@ -268,4 +271,130 @@ private:
     }
   } m_items;
 };
+
+// Shared Timer Queue
+//
+// Lightweight front-end to a single TimerQueue shared by the whole process.
+// It has the same interface as TimerQueue, but it does NOT own a thread:
+// all the instances alive at a given time use the same worker, that is
+// created with the first instance and destroyed with the last one.
+//
+// Guarantees (same as TimerQueue):
+//  - All handlers are executed ONCE, even if canceled (aborted parameter will
+//be set to true)
+//      - If SharedTimerQueue is destroyed, it will cancel its own handlers
+//        and wait until they have been executed.
+//  - Handlers are ALWAYS executed in the shared worker thread.
+//  - cancelAll() affects only the timers added through this instance.
+//
+template <typename _Clock = std::chrono::steady_clock,
+          typename _Duration = std::chrono::steady_clock::duration>
+class SharedTimerQueue
+{
+public:
+  using Queue = TimerQueue<_Clock, _Duration>;
+
+  SharedTimerQueue() : m_queue(sharedQueue())
+  {}
+
+  ~SharedTimerQueue()
+  {
+    cancelAll();
+    // handlers capture "this" (directly or through their owner):
+    // we must wait until all of them have been consumed.
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_done.wait(lk, [this] { return m_pending.empty(); });
+  }
+
+  //! Adds a new timer
+  // \return
+  //  Returns the ID of the new timer. You can use this ID to cancel the
+  // timer
+  uint64_t add(std::chrono::milliseconds milliseconds, std::function<void(bool)> handler)
+  {
+    // Keep the lock while adding, so that the handler can not be executed
+    // before its id is registered in m_pending.
+    std::unique_lock<std::mutex> lk(m_mtx);
+    auto id = std::make_shared<uint64_t>(0);
+    *id = m_queue->add(milliseconds,
+                       [this, id, handler = std::move(handler)](bool aborted) {
+                         handler(aborted);
+                         std::lock_guard<std::mutex> lock(m_mtx);
+                         m_pending.erase(
+                             std::find(m_pending.begin(), m_pending.end(), *id));
+                         m_done.notify_all();
+                       });
+    m_pending.push_back(*id);
+    return *id;
+  }
+
+  //! Cancels the specified timer
+  // \return
+  //  1 if the timer was cancelled.
+  //  0 if you were too late to cancel (or the timer ID was never valid to
+  // start with)
+  size_t cancel(uint64_t id)
+  {
+    return m_queue->cancel(id);
+  }
+
+  //! Cancels all the timers added by this instance
+  // \return
+  //  The number of timers cancelled
+  size_t cancelAll()
+  {
+    std::vector<uint64_t> pending;
+    {
+      std::lock_guard<std::mutex> lk(m_mtx);
+      pending = m_pending;
+    }
+    size_t count = 0;
+    for (auto id : pending)
+    {
+      count += m_queue->cancel(id);
+    }
+    return count;
+  }
+
+  //! Number of SharedTimerQueue currently using the shared worker
+  static long useCount()
+  {
+    std::lock_guard<std::mutex> lk(sharedMutex());
+    return sharedInstance().use_count();
+  }
+
+private:
+  SharedTimerQueue(const SharedTimerQueue&) = delete;
+  SharedTimerQueue& operator=(const SharedTimerQueue&) = delete;
+
+  static std::mutex& sharedMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static std::weak_ptr<Queue>& sharedInstance()
+  {
+    static std::weak_ptr<Queue> instance;
+    return instance;
+  }
+
+  static std::shared_ptr<Queue> sharedQueue()
+  {
+    std::lock_guard<std::mutex> lk(sharedMutex());
+    auto queue = sharedInstance().lock();
+    if (!queue)
+    {
+      queue = std::make_shared<Queue>();
+      sharedInstance() = queue;
+    }
+    return queue;
+  }
+
+  std::shared_ptr<Queue> m_queue;
+  std::mutex m_mtx;
+  std::condition_variable m_done;
+  std::vector<uint64_t> m_pending;
+};
+
 }   // namespace BT
@@ -5,6 +5,7 @@
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <functional>
 
 namespace BT
 {
@@ -28,6 +29,24 @@ public:
     {
        ready_ = true;
        cv_.notify_all();
+       if (has_listener_)
+       {
+         std::unique_lock<std::mutex> lk(listener_mutex_);
+         if (listener_)
+         {
+           listener_();
+         }
+       }
+    }
+
+    /// The listener is invoked by emitSignal(), in the thread that emits it.
+    /// Use an empty function to remove it: when setListener() returns,
+    /// the previous listener is not being executed anymore.
+    void setListener(std::function<void()> listener)
+    {
+      std::unique_lock<std::mutex> lk(listener_mutex_);
+      listener_ = std::move(listener);
+      has_listener_ = bool(listener_);
     }
 
 private:
@@ -35,6 +54,10 @@ private:
     std::mutex mutex_;
     std::condition_variable cv_;
     std::atomic_bool ready_ = false;
+
+    std::mutex listener_mutex_;
+    std::function<void()> listener_;
+    std::atomic_bool has_listener_ = false;
 };
 
 }
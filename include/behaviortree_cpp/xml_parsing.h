@@ -37,6 +37,9 @@ public:
   instantiateTree(const Blackboard::Ptr& root_blackboard,
                   std::string main_tree_to_execute = {}) override;
 
+  [[nodiscard]] TreeTemplate
+  createTreeTemplate(std::string main_tree_to_execute = {}) override;
+
   void clearInternalState() override;
 
 private:
@@ -14,6 +14,7 @@
 #define MINICORO_IMPL
 #include "minicoro/minicoro.h"
 #include "behaviortree_cpp/action_node.h"
+#include "behaviortree_cpp/utils/coro_stack_pool.h"
 
 using namespace BT;
 
@@ -69,15 +70,26 @@ struct CoroActionNode::Pimpl
 {
   mco_coro* coro = nullptr;
   mco_desc desc;
+  bool desc_initialized = false;
+  std::shared_ptr<CoroStackPool> pool;
 };
 
 void CoroEntry(mco_coro* co) {
   static_cast<CoroActionNode*>(co->user_data)->tickImpl();
 }
 
+void* CoroPoolAllocate(size_t size, void* pool) {
+  return static_cast<CoroStackPool*>(pool)->allocate(size);
+}
+
+void CoroPoolDeallocate(void* ptr, void* pool) {
+  static_cast<CoroStackPool*>(pool)->deallocate(ptr);
+}
+
 CoroActionNode::CoroActionNode(const std::string& name, const NodeConfig& config) :
   ActionNodeBase(name, config), _p(new Pimpl)
 {
+  _p->pool = config.coro_stack_pool;
 }
 
 CoroActionNode::~CoroActionNode()
@@ -97,8 +109,21 @@ NodeStatus CoroActionNode::executeTick()
   if(_p->coro == nullptr)
   {
     // First initialize a `desc` object through `mco_desc_init`.
-    _p->desc = mco_desc_init(CoroEntry, 0);
-    _p->desc.user_data = this;
+    // The registration ID (that selects the stack size) is known only
+    // after construction, therefore this is done at the first tick.
+    if(!_p->desc_initialized)
+    {
+      const size_t stack_size = _p->pool ? _p->pool->stackSize(registrationName()) : 0;
+      _p->desc = mco_desc_init(CoroEntry, stack_size);
+      _p->desc.user_data = this;
+      if(_p->pool)
+      {
+        _p->desc.malloc_cb = CoroPoolAllocate;
+        _p->desc.free_cb = CoroPoolDeallocate;
+        _p->desc.allocator_data = _p->pool.get();
+      }
+      _p->desc_initialized = true;
+    }
 
     mco_result res = mco_create(&_p->coro, &_p->desc);
     if(res != MCO_SUCCESS)
@@ -136,6 +161,11 @@ void CoroActionNode::destroyCoroutine()
 {
   if(_p->coro)
   {
+    if(_p->pool)
+    {
+      _p->pool->recordStackUsage(registrationName(), _p->coro->stack_base,
+                                 _p->coro->stack_size);
+    }
     mco_result res = mco_destroy(_p->coro);
     if(res != MCO_SUCCESS)
     {
@@ -196,7 +226,21 @@ NodeStatus BT::ThreadedAction::executeTick()
   {
     setStatus(NodeStatus::RUNNING);
     halt_requested_ = false;
-    thread_handle_ = std::async(std::launch::async, [this]() {
+    if (!executor_)
+    {
+      executor_ = config().executor;
+      if (!executor_)
+      {
+        executor_ = ThreadPool::defaultPool();
+      }
+    }
+    // packaged_task is not copyable, std::function requires it
+    auto task = std::make_shared<std::packaged_task<void()>>([this]() {
+      // halted while waiting in the queue of the executor
+      if (isHaltRequested())
+      {
+        return;
+      }
       try
       {
         auto status = tick();
@@ -217,6 +261,8 @@ NodeStatus BT::ThreadedAction::executeTick()
       }
       emitWakeUpSignal();
     });
+    thread_handle_ = task->get_future();
+    executor_->execute([task]() { (*task)(); });
   }
 
   lock_type l(mutex_);
@@ -231,6 +277,14 @@ NodeStatus BT::ThreadedAction::executeTick()
   return status();
 }
 
+ThreadedAction::~ThreadedAction()
+{
+  if (thread_handle_.valid())
+  {
+    thread_handle_.wait();
+  }
+}
+
 void ThreadedAction::halt()
 {
   halt_requested_.store(true);
@@ -10,7 +10,8 @@ void BT::TestNode::setConfig(const TestNodeConfig &config)
 
   if(!_test_config.post_script.empty())
   {
-    auto executor = ParseScript(_test_config.post_script);
+    auto executor = ParseScript(_test_config.post_script,
+                                TreeNode::config().script_cache.get());
     if (!executor)
     {
       throw RuntimeError(executor.error());
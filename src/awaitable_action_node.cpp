@@ -0,0 +1,164 @@
+#include "behaviortree_cpp/awaitable_action_node.h"
+
+namespace BT
+{
+
+AwaitableActionNode::AwaitableActionNode(const std::string& name,
+                                         const NodeConfig& config) :
+  ActionNodeBase(name, config)
+{}
+
+AwaitableActionNode::~AwaitableActionNode()
+{
+  cancelTimer();
+}
+
+void AwaitableActionNode::notify()
+{
+  notified_ = true;
+  emitWakeUpSignal();
+}
+
+void AwaitableActionNode::halt()
+{
+  cancelTimer();
+  task_.reset();
+  condition_ = {};
+  notified_ = false;
+  resetStatus();
+}
+
+AwaitableActionNode::Awaiter AwaitableActionNode::nextTick()
+{
+  return Awaiter(this, {});
+}
+
+AwaitableActionNode::Awaiter AwaitableActionNode::sleepFor(std::chrono::milliseconds timeout)
+{
+  WaitCondition condition;
+  condition.type = WaitCondition::DEADLINE;
+  condition.deadline = std::chrono::steady_clock::now() + timeout;
+  return Awaiter(this, std::move(condition));
+}
+
+AwaitableActionNode::Awaiter AwaitableActionNode::notification()
+{
+  WaitCondition condition;
+  condition.type = WaitCondition::NOTIFICATION;
+  return Awaiter(this, std::move(condition));
+}
+
+AwaitableActionNode::Awaiter AwaitableActionNode::entryUpdated(const std::string& port_name)
+{
+  auto remap_it = config().input_ports.find(port_name);
+  if (remap_it == config().input_ports.end())
+  {
+    remap_it = config().output_ports.find(port_name);
+    if (remap_it == config().output_ports.end())
+    {
+      throw RuntimeError("AwaitableActionNode::entryUpdated: port [", port_name,
+                         "] not found in node [", fullPath(), "]");
+    }
+  }
+  auto key = getRemappedKey(port_name, remap_it->second);
+  if (!key)
+  {
+    throw RuntimeError("AwaitableActionNode::entryUpdated: port [", port_name,
+                       "] of node [", fullPath(), "] is not a blackboard entry");
+  }
+  auto entry = config().blackboard->getEntry(std::string(key.value()));
+  if (!entry)
+  {
+    throw RuntimeError("AwaitableActionNode::entryUpdated: missing entry [",
+                       key.value(), "] in the blackboard");
+  }
+  WaitCondition condition;
+  condition.type = WaitCondition::ENTRY_UPDATE;
+  condition.sequence_id = entry->sequence_id.load(std::memory_order_acquire);
+  condition.entry = std::move(entry);
+  return Awaiter(this, std::move(condition));
+}
+
+NodeStatus AwaitableActionNode::tick()
+{
+  if (!task_.handle_)
+  {
+    notified_ = false;
+    task_ = run();
+  }
+  else if (!isSatisfied(condition_))
+  {
+    // nothing happened: there is no need to resume the coroutine
+    return NodeStatus::RUNNING;
+  }
+  condition_ = {};
+
+  task_.handle_.resume();
+
+  if (!task_.handle_.done())
+  {
+    return NodeStatus::RUNNING;
+  }
+  const auto& promise = task_.handle_.promise();
+  const NodeStatus result = promise.status;
+  const std::exception_ptr exception = promise.exception;
+  task_.reset();
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+  if (result == NodeStatus::IDLE || result == NodeStatus::RUNNING)
+  {
+    throw LogicError("AwaitableActionNode::run() of [", fullPath(),
+                     "] must co_return SUCCESS, FAILURE or SKIPPED");
+  }
+  return result;
+}
+
+bool AwaitableActionNode::isSatisfied(const WaitCondition& condition)
+{
+  switch (condition.type)
+  {
+    case WaitCondition::NEXT_TICK:
+      return true;
+    case WaitCondition::DEADLINE:
+      return std::chrono::steady_clock::now() >= condition.deadline;
+    case WaitCondition::NOTIFICATION:
+      return notified_.exchange(false);
+    case WaitCondition::ENTRY_UPDATE:
+      return condition.entry->sequence_id.load(std::memory_order_acquire) !=
+             condition.sequence_id;
+  }
+  return true;
+}
+
+void AwaitableActionNode::suspendUntil(WaitCondition condition)
+{
+  condition_ = std::move(condition);
+
+  if (condition_.type == WaitCondition::DEADLINE)
+  {
+    cancelTimer();
+    const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(
+        condition_.deadline - std::chrono::steady_clock::now());
+    timer_waiting_ = true;
+    timer_id_ = timer_.add(timeout, [this](bool aborted) {
+      if (!aborted)
+      {
+        emitWakeUpSignal();
+      }
+      timer_waiting_ = false;
+    });
+  }
+}
+
+void AwaitableActionNode::cancelTimer()
+{
+  if (timer_waiting_)
+  {
+    timer_.cancel(timer_id_);
+  }
+}
+
+}   // namespace BT
@@ -13,7 +13,7 @@ void Blackboard::enableAutoRemapping(bool remapping)
   autoremapping_ = remapping;
 }
 
-AnyPtrLocked Blackboard::getAnyLocked(const std::string &key)
+AnyPtrLocked Blackboard::getAnyLocked(StringView key)
 {
   if(auto entry = getEntry(key))
   {
@@ -22,7 +22,7 @@ AnyPtrLocked Blackboard::getAnyLocked(const std::string &key)
   return {};
 }
 
-AnyPtrLocked Blackboard::getAnyLocked(const std::string &key) const
+AnyPtrLocked Blackboard::getAnyLocked(StringView key) const
 {
   if(auto entry = getEntry(key))
   {
@@ -31,21 +31,56 @@ AnyPtrLocked Blackboard::getAnyLocked(const std::string &key) const
   return {};
 }
 
-const Any *Blackboard::getAny(const std::string &key) const
+AnyPtrLocked Blackboard::getAnyLocked(KeyID key)
+{
+  if(auto entry = getEntry(key))
+  {
+    return AnyPtrLocked(&entry->value, &entry->entry_mutex);
+  }
+  return {};
+}
+
+AnyPtrLocked Blackboard::getAnyLocked(KeyID key) const
+{
+  if(auto entry = getEntry(key))
+  {
+    return AnyPtrLocked(&entry->value, const_cast<std::mutex*>(&entry->entry_mutex));
+  }
+  return {};
+}
+
+const Any *Blackboard::getAny(StringView key) const
 {
   return getAnyLocked(key).get();
 }
 
-Any *Blackboard::getAny(const std::string &key)
+Any *Blackboard::getAny(StringView key)
 {
   return const_cast<Any*>(getAnyLocked(key).get());
 }
 
-const std::shared_ptr<Blackboard::Entry> Blackboard::getEntry(const std::string &key) const
+// A key that was never interned can not be in any blackboard:
+// there is no need to add it to the SymbolTable.
+
+const std::shared_ptr<Blackboard::Entry> Blackboard::getEntry(StringView key) const
+{
+  const auto id = SymbolTable::global().find(key);
+  return (id == SymbolTable::InvalidID) ? nullptr : getEntry(id);
+}
+
+std::shared_ptr<Blackboard::Entry> Blackboard::getEntry(StringView key)
+{
+  const auto id = SymbolTable::global().find(key);
+  return (id == SymbolTable::InvalidID) ? nullptr : getEntry(id);
+}
+
+const std::shared_ptr<Blackboard::Entry> Blackboard::getEntry(KeyID key) const
 {
   std::unique_lock<std::mutex> lock(mutex_);
-  auto it = storage_.find(key);
-  if(it != storage_.end()) {
+  if(auto entry = findLocal(key)) {
+    return *entry;
+  }
+  if(auto it = remapped_entries_.find(key); it != remapped_entries_.end()) {
     return it->second;
   }
   // not found. Try autoremapping
@@ -54,24 +89,24 @@ const std::shared_ptr<Blackboard::Entry> Blackboard::getEntry(const std::string
     auto remap_it = internal_to_external_.find(key);
     if (remap_it != internal_to_external_.cend())
     {
-      auto const& new_key = remap_it->second;
-      return parent->getEntry(new_key);
+      return static_cast<const Blackboard&>(*parent).getEntry(remap_it->second);
     }
-    if(autoremapping_ && !IsPrivateKey(key))
+    if(autoremapping_ && !IsPrivateKey(SymbolTable::global().str(key)))
     {
-      return parent->getEntry(key);
+      return static_cast<const Blackboard&>(*parent).getEntry(key);
     }
   }
   return {};
 }
 
-
-std::shared_ptr<Blackboard::Entry> Blackboard::getEntry(const std::string &key)
+std::shared_ptr<Blackboard::Entry> Blackboard::getEntry(KeyID key)
 {
   std::unique_lock<std::mutex> lock(mutex_);
-  auto it = storage_.find(key);
-  if(it != storage_.end()) {
-    return it->second;
+  if(auto entry = findLocal(key)) {
+    return *entry;
+  }
+  if(auto entry = takeRemapped(key)) {
+    return *entry;
   }
 
   // not found. Try autoremapping
@@ -80,20 +115,19 @@ std::shared_ptr<Blackboard::Entry> Blackboard::getEntry(const std::string &key)
     auto remap_it = internal_to_external_.find(key);
     if (remap_it != internal_to_external_.cend())
     {
-      auto const& new_key = remap_it->second;
-      auto entry = parent->getEntry(new_key);
+      auto entry = parent->getEntry(remap_it->second);
       if(entry)
       {
-        storage_.insert({key, entry});
+        insertLocal(key, entry);
       }
       return entry;
     }
-    if(autoremapping_ && !IsPrivateKey(key))
+    if(autoremapping_ && !IsPrivateKey(SymbolTable::global().str(key)))
     {
       auto entry = parent->getEntry(key);
       if(entry)
       {
-        storage_.insert({key, entry});
+        insertLocal(key, entry);
       }
       return entry;
     }
@@ -101,23 +135,85 @@ std::shared_ptr<Blackboard::Entry> Blackboard::getEntry(const std::string &key)
   return {};
 }
 
+void Blackboard::insertLocal(KeyID key, std::shared_ptr<Entry> entry)
+{
+  storage_.emplace(key, std::move(entry));
+}
+
+std::shared_ptr<Blackboard::Entry>* Blackboard::takeRemapped(KeyID key)
+{
+  auto node = remapped_entries_.extract(key);
+  if(node.empty())
+  {
+    return nullptr;
+  }
+  auto [it, inserted] = storage_.emplace(key, std::move(node.mapped()));
+  return &it->second;
+}
 
-const TypeInfo* Blackboard::entryInfo(const std::string& key)
+void Blackboard::unset(StringView key)
 {
+  const auto id = SymbolTable::global().find(key);
   std::unique_lock<std::mutex> lock(mutex_);
+  if(id == SymbolTable::InvalidID ||
+     (storage_.erase(id) + remapped_entries_.erase(id)) == 0)
+  {
+    // No entry, nothing to do.
+    return;
+  }
+  removed_entries_++;
+}
 
-  auto it = storage_.find(key);
+const TypeInfo* Blackboard::entryInfo(StringView key)
+{
+  const auto id = SymbolTable::global().find(key);
+  if(id == SymbolTable::InvalidID)
+  {
+    return nullptr;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = storage_.find(id);
   return (it == storage_.end()) ? nullptr : &(it->second->info);
 }
 
 void Blackboard::addSubtreeRemapping(StringView internal, StringView external)
 {
-  internal_to_external_.insert(
-      {static_cast<std::string>(internal), static_cast<std::string>(external)});
+  auto& symbols = SymbolTable::global();
+  internal_to_external_.insert({symbols.intern(internal), symbols.intern(external)});
+}
+
+void Blackboard::resolveRemappedEntries()
+{
+  auto parent = parent_bb_.lock();
+  if (!parent || internal_to_external_.empty())
+  {
+    return;
+  }
+  // the const getEntry() doesn't add anything to the storage of the parent
+  const Blackboard& const_parent = *parent;
+  std::vector<std::pair<KeyID, std::shared_ptr<Entry>>> resolved;
+  for (const auto& [internal, external] : internal_to_external_)
+  {
+    if (auto entry = const_parent.getEntry(external))
+    {
+      resolved.emplace_back(internal, std::move(entry));
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto& [key, entry] : resolved)
+  {
+    // local entries win
+    if (storage_.count(key) == 0)
+    {
+      remapped_entries_.emplace(key, std::move(entry));
+    }
+  }
 }
 
 void Blackboard::debugMessage() const
 {
+  const auto& symbols = SymbolTable::global();
   for (const auto& [key, entry] : storage_)
   {
     auto port_type = entry->info.type();
@@ -126,12 +222,13 @@ void Blackboard::debugMessage() const
       port_type = entry->value.type();
     }
 
-    std::cout << key << " (" << BT::demangle(port_type) << ")" << std::endl;
+    std::cout << symbols.str(key) << " (" << BT::demangle(port_type) << ")" << std::endl;
   }
 
   for (const auto& [from, to] : internal_to_external_)
   {
-    std::cout << "[" << from << "] remapped to port of parent tree [" << to << "]"
+    std::cout << "[" << symbols.str(from) << "] remapped to port of parent tree ["
+              << symbols.str(to) << "]"
               << std::endl;
     continue;
   }
@@ -139,15 +236,17 @@ void Blackboard::debugMessage() const
 
 std::vector<StringView> Blackboard::getKeys() const
 {
+  std::unique_lock<std::mutex> lock(mutex_);
   if (storage_.empty())
   {
     return {};
   }
+  const auto& symbols = SymbolTable::global();
   std::vector<StringView> out;
   out.reserve(storage_.size());
-  for (const auto& entry_it : storage_)
+  for (const auto& [key, entry] : storage_)
   {
-    out.push_back(entry_it.first);
+    out.push_back(symbols.str(key));
   }
   return out;
 }
@@ -156,6 +255,8 @@ void Blackboard::clear()
 {
   std::unique_lock<std::mutex> lock(mutex_);
   storage_.clear();
+  remapped_entries_.clear();
+  removed_entries_++;
 }
 
 std::recursive_mutex &Blackboard::entryMutex() const
@@ -163,28 +264,32 @@ std::recursive_mutex &Blackboard::entryMutex() const
   return entry_mutex_;
 }
 
-void Blackboard::createEntry(const std::string &key, const TypeInfo &info)
+void Blackboard::createEntry(StringView key, const TypeInfo &info)
 {
-  createEntryImpl(key, info);
+  createEntryImpl(keyID(key), info);
 }
 
 std::shared_ptr<Blackboard::Entry>
-Blackboard::createEntryImpl(const std::string& key, const TypeInfo& info)
+Blackboard::createEntryImpl(KeyID key, const TypeInfo& info)
 {
   std::unique_lock<std::mutex> lock(mutex_);
   // This function might be called recursively, when we do remapping, because we move
   // to the top scope to find already existing  entries
 
   // search if exists already
-  auto storage_it = storage_.find(key);
-  if(storage_it != storage_.end())
+  auto prev_entry = findLocal(key);
+  if(!prev_entry)
+  {
+    prev_entry = takeRemapped(key);
+  }
+  if(prev_entry)
   {
-    const auto& prev_info = storage_it->second->info;
+    const auto& prev_info = (*prev_entry)->info;
     if (prev_info.type() != info.type() &&
         prev_info.isStronglyTyped() &&
         info.isStronglyTyped())
     {
-      auto msg = StrCat("Blackboard entry [", key, "]: once declared, the type of a port"
+      auto msg = StrCat("Blackboard entry [", SymbolTable::global().str(key), "]: once declared, the type of a port"
                         " shall not change. Previously declared type [",
                         BT::demangle(prev_info.type()),
                         "], current type [",
@@ -192,7 +297,7 @@ Blackboard::createEntryImpl(const std::string& key, const TypeInfo& info)
 
       throw LogicError(msg);
     }
-    return storage_it->second;
+    return *prev_entry;
   }
 
   std::shared_ptr<Entry> entry;
@@ -207,7 +312,7 @@ Blackboard::createEntryImpl(const std::string& key, const TypeInfo& info)
       entry = parent->createEntryImpl(remapped_key, info);
     }
   }
-  else if(autoremapping_ && !IsPrivateKey(key))
+  else if(autoremapping_ && !IsPrivateKey(SymbolTable::global().str(key)))
   {
     if (auto parent = parent_bb_.lock())
     {
@@ -220,7 +325,7 @@ Blackboard::createEntryImpl(const std::string& key, const TypeInfo& info)
     // even if empty, let's assign to it a default type
     entry->value = Any(info.type());
   }
-  storage_.insert( {key, entry} );
+  insertLocal(key, entry);
   return entry;
 }
 
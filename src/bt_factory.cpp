@@ -10,7 +10,9 @@
 *   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <atomic>
 #include <filesystem>
+#include <limits>
 #include <fstream>
 #include "behaviortree_cpp/bt_factory.h"
 #include "behaviortree_cpp/utils/shared_library.h"
@@ -30,15 +32,193 @@ bool WildcardMatch(std::string const& str, StringView filter)
   return wildcards::match(str, filter);
 }
 
+namespace
+{
+
+/**
+ * SubstitutionMatcher finds the substitution rule to apply to a node,
+ * testing with WildcardMatch only the filters that may match its path.
+ *
+ * The filters are indexed in a prefix tree by the literal text that
+ * precedes the first wildcard or, if longer, in a suffix tree by the
+ * literal text that follows the last one.
+ * Filters without wildcards are found with a single lookup.
+ *
+ * If more than one rule match, the first one in the iteration order of
+ * the rules is selected.
+ */
+class SubstitutionMatcher
+{
+public:
+  using Rules = std::unordered_map<std::string, BehaviorTreeFactory::SubstitutionRule>;
+
+  explicit SubstitutionMatcher(const Rules& rules)
+  {
+    prefix_tree_.emplace_back();
+    suffix_tree_.emplace_back();
+
+    for (const auto& [filter, rule] : rules)
+    {
+      const auto index = uint32_t(rules_.size());
+      rules_.push_back({ &filter, &rule });
+      exact_.insert({ filter, index });
+
+      const auto first = filter.find_first_of(special_chars);
+      if (first == std::string::npos)
+      {
+        // equivalent to (filter == path)
+        continue;
+      }
+      const auto last = filter.find_last_of(special_chars);
+      const auto prefix = StringView(filter).substr(0, first);
+      const auto suffix = StringView(filter).substr(last + 1);
+
+      if (prefix.size() >= suffix.size())
+      {
+        insert(prefix_tree_, prefix.begin(), prefix.end(), index);
+      }
+      else
+      {
+        insert(suffix_tree_, suffix.rbegin(), suffix.rend(), index);
+      }
+    }
+  }
+
+  const BehaviorTreeFactory::SubstitutionRule* find(const std::string& name,
+                                                    const std::string& ID,
+                                                    const std::string& path) const
+  {
+    uint32_t best = NOT_FOUND;
+
+    for (const auto* key : { &name, &ID, &path })
+    {
+      auto it = exact_.find(*key);
+      if (it != exact_.end())
+      {
+        best = std::min(best, it->second);
+      }
+    }
+
+    auto test = [&](uint32_t index) {
+      if (index < best && wildcards::match(path, *rules_[index].filter))
+      {
+        best = index;
+      }
+    };
+    visit(prefix_tree_, path.begin(), path.end(), test);
+    visit(suffix_tree_, path.rbegin(), path.rend(), test);
+
+    return best == NOT_FOUND ? nullptr : rules_[best].rule;
+  }
+
+private:
+  // characters with a special meaning in WildcardMatch
+  static constexpr const char* special_chars = "*?\\[]()|";
+  static constexpr uint32_t NOT_FOUND = std::numeric_limits<uint32_t>::max();
+
+  struct RuleRef
+  {
+    const std::string* filter;
+    const BehaviorTreeFactory::SubstitutionRule* rule;
+  };
+
+  struct TrieNode
+  {
+    std::vector<std::pair<char, uint32_t>> children;
+    // filters with this literal prefix (or suffix)
+    std::vector<uint32_t> rules;
+  };
+  using Trie = std::vector<TrieNode>;
+
+  template <typename It>
+  static void insert(Trie& trie, It begin, It end, uint32_t index)
+  {
+    uint32_t node = 0;
+    for (auto it = begin; it != end; ++it)
+    {
+      auto& children = trie[node].children;
+      auto child = std::find_if(children.begin(), children.end(),
+                                [c = *it](const auto& pair) { return pair.first == c; });
+      if (child != children.end())
+      {
+        node = child->second;
+      }
+      else
+      {
+        const auto new_node = uint32_t(trie.size());
+        children.push_back({ *it, new_node });
+        trie.emplace_back();
+        node = new_node;
+      }
+    }
+    trie[node].rules.push_back(index);
+  }
+
+  template <typename It, typename Func>
+  static void visit(const Trie& trie, It begin, It end, const Func& func)
+  {
+    uint32_t node = 0;
+    auto it = begin;
+    while (true)
+    {
+      for (auto index : trie[node].rules)
+      {
+        func(index);
+      }
+      if (it == end)
+      {
+        return;
+      }
+      const auto& children = trie[node].children;
+      auto child = std::find_if(children.begin(), children.end(),
+                                [c = *it](const auto& pair) { return pair.first == c; });
+      if (child == children.end())
+      {
+        return;
+      }
+      node = child->second;
+      ++it;
+    }
+  }
+
+  std::vector<RuleRef> rules_;
+  std::unordered_map<std::string, uint32_t> exact_;
+  Trie prefix_tree_;
+  Trie suffix_tree_;
+};
+
+}   // namespace
+
 struct BehaviorTreeFactory::PImpl
 {
   std::unordered_map<std::string, NodeBuilder> builders;
   std::unordered_map<std::string, TreeNodeManifest> manifests;
+  // copy of manifests, reset when they change
+  std::shared_ptr<const ManifestsSnapshot::Map> manifests_snapshot;
   std::set<std::string> builtin_IDs;
   std::unordered_map<std::string, Any> behavior_tree_definitions;
   std::shared_ptr<std::unordered_map<std::string, int>> scripting_enums;
   std::shared_ptr<BT::Parser> parser;
   std::unordered_map<std::string, SubstitutionRule> substitution_rules;
+  // created from substitution_rules when needed, reset when they change
+  std::unique_ptr<SubstitutionMatcher> substitution_matcher;
+  bool node_arena = false;
+  std::shared_ptr<ScriptCache> script_cache = std::make_shared<ScriptCache>();
+  std::shared_ptr<Executor> executor;
+  CoroStackPool::Options coro_stack_pool_options;
+
+  std::atomic_bool frozen = false;
+  // trees compiled by freeze(). Never modified once frozen
+  std::unordered_map<std::string, TreeTemplate> templates;
+
+  void checkNotFrozen(const char* method) const
+  {
+    if (frozen)
+    {
+      throw LogicError("BehaviorTreeFactory::", method,
+                       " can not be called after freeze()");
+    }
+  }
 };
 
 BehaviorTreeFactory::BehaviorTreeFactory():
@@ -57,6 +237,7 @@ BehaviorTreeFactory::BehaviorTreeFactory():
 
   registerNodeType<ParallelNode>("Parallel");
   registerNodeType<ParallelAllNode>("ParallelAll");
+  registerNodeType<ConcurrentParallelNode>("ConcurrentParallel");
   registerNodeType<ReactiveSequence>("ReactiveSequence");
   registerNodeType<ReactiveFallback>("ReactiveFallback");
   registerNodeType<IfThenElseNode>("IfThenElse");
@@ -121,6 +302,7 @@ BehaviorTreeFactory::~BehaviorTreeFactory()
 
 bool BehaviorTreeFactory::unregisterBuilder(const std::string& ID)
 {
+  _p->checkNotFrozen("unregisterBuilder");
   if (builtinNodes().count(ID))
   {
     throw LogicError("You can not remove the builtin registration ID [", ID, "]");
@@ -132,12 +314,14 @@ bool BehaviorTreeFactory::unregisterBuilder(const std::string& ID)
   }
   _p->builders.erase(ID);
   _p->manifests.erase(ID);
+  std::atomic_store(&_p->manifests_snapshot, {});
   return true;
 }
 
 void BehaviorTreeFactory::registerBuilder(const TreeNodeManifest& manifest,
                                           const NodeBuilder& builder)
 {
+  _p->checkNotFrozen("registerBuilder");
   auto it = _p->builders.find(manifest.registration_ID);
   if (it != _p->builders.end())
   {
@@ -146,6 +330,7 @@ void BehaviorTreeFactory::registerBuilder(const TreeNodeManifest& manifest,
 
   _p->builders.insert({manifest.registration_ID, builder});
   _p->manifests.insert({manifest.registration_ID, manifest});
+  std::atomic_store(&_p->manifests_snapshot, {});
 }
 
 void BehaviorTreeFactory::registerSimpleCondition(
@@ -268,11 +453,13 @@ void BehaviorTreeFactory::registerFromROSPlugins()
 
 void BehaviorTreeFactory::registerBehaviorTreeFromFile(const std::filesystem::path &filename)
 {
+  _p->checkNotFrozen("registerBehaviorTreeFromFile");
   _p->parser->loadFromFile(filename);
 }
 
 void BehaviorTreeFactory::registerBehaviorTreeFromText(const std::string& xml_text)
 {
+  _p->checkNotFrozen("registerBehaviorTreeFromText");
   _p->parser->loadFromText(xml_text);
 }
 
@@ -283,6 +470,7 @@ std::vector<std::string> BehaviorTreeFactory::registeredBehaviorTrees() const
 
 void BehaviorTreeFactory::clearRegisteredBehaviorTrees()
 {
+  _p->checkNotFrozen("clearRegisteredBehaviorTrees");
   _p->parser->clearInternalState();
 }
 
@@ -309,36 +497,38 @@ std::unique_ptr<TreeNode> BehaviorTreeFactory::instantiateTreeNode(
   std::unique_ptr<TreeNode> node;
 
   bool substituted = false;
-  for(const auto& [filter, rule]: _p->substitution_rules)
+  if (!_p->substitution_rules.empty())
   {
-    if( filter == name || filter == ID || wildcards::match(config.path, filter))
+    if (!_p->substitution_matcher)
     {
-      // first case: the rule is simply a string with the name of the
-      // node to create instead
-      if(const auto substituted_ID = std::get_if<std::string>(&rule) )
+      _p->substitution_matcher =
+          std::make_unique<SubstitutionMatcher>(_p->substitution_rules);
+    }
+    const auto rule = _p->substitution_matcher->find(name, ID, config.path);
+
+    // first case: the rule is simply a string with the name of the
+    // node to create instead
+    if (const auto substituted_ID = rule ? std::get_if<std::string>(rule) : nullptr)
+    {
+      auto it_builder = _p->builders.find(*substituted_ID);
+      if (it_builder != _p->builders.end())
       {
-        auto it_builder = _p->builders.find(*substituted_ID);
-        if (it_builder != _p->builders.end())
-        {
-          auto& builder = it_builder->second;
-          node = builder(name, config);
-        }
-        else{
-          throw RuntimeError("Substituted Node ID not found");
-        }
-        substituted = true;
-        break;
+        auto& builder = it_builder->second;
+        node = builder(name, config);
       }
-      else if(const auto test_config = std::get_if<TestNodeConfig>(&rule) )
-      {
-        // second case, the varian is a TestNodeConfig
-        auto test_node = new TestNode(name, config);
-        test_node->setConfig(*test_config);
-
-        node.reset(test_node);
-        substituted = true;
-        break;
+      else{
+        throw RuntimeError("Substituted Node ID not found");
       }
+      substituted = true;
+    }
+    else if (const auto test_config = rule ? std::get_if<TestNodeConfig>(rule) : nullptr)
+    {
+      // second case, the varian is a TestNodeConfig
+      auto test_node = new TestNode(name, config);
+      test_node->setConfig(*test_config);
+
+      node.reset(test_node);
+      substituted = true;
     }
   }
 
@@ -357,10 +547,10 @@ std::unique_ptr<TreeNode> BehaviorTreeFactory::instantiateTreeNode(
   node->setRegistrationID(ID);
   node->config().enums = _p->scripting_enums;
 
-  auto AssignConditions = [](auto& conditions, auto& executors) {
+  auto AssignConditions = [this](auto& conditions, auto& executors) {
     for (const auto& [cond_id, script] : conditions)
     {
-      if (auto executor = ParseScript(script))
+      if (auto executor = _p->script_cache->parse(script))
       {
         executors[size_t(cond_id)] = executor.value();
       }
@@ -387,6 +577,19 @@ BehaviorTreeFactory::manifests() const
   return _p->manifests;
 }
 
+ManifestsSnapshot BehaviorTreeFactory::manifestsSnapshot() const
+{
+  // the snapshot is created lazily: concurrent callers may create it twice,
+  // but they all get a valid one
+  auto snapshot = std::atomic_load(&_p->manifests_snapshot);
+  if (!snapshot)
+  {
+    snapshot = std::make_shared<const ManifestsSnapshot::Map>(_p->manifests);
+    std::atomic_store(&_p->manifests_snapshot, snapshot);
+  }
+  return ManifestsSnapshot(std::move(snapshot));
+}
+
 const std::set<std::string>& BehaviorTreeFactory::builtinNodes() const
 {
   return _p->builtin_IDs;
@@ -405,7 +608,7 @@ Tree BehaviorTreeFactory::createTreeFromText(const std::string& text,
   XMLParser parser(*this);
   parser.loadFromText(text);
   auto tree = parser.instantiateTree(blackboard);
-  tree.manifests = this->manifests();
+  tree.manifests = manifestsSnapshot();
   return tree;
 }
 
@@ -423,42 +626,141 @@ Tree BehaviorTreeFactory::createTreeFromFile(const std::filesystem::path &file_p
   XMLParser parser(*this);
   parser.loadFromFile(file_path);
   auto tree = parser.instantiateTree(blackboard);
-  tree.manifests = this->manifests();
+  tree.manifests = manifestsSnapshot();
   return tree;
 }
 
 Tree BehaviorTreeFactory::createTree(const std::string& tree_name,
                                      Blackboard::Ptr blackboard)
 {
+  if (_p->frozen)
+  {
+    auto it = _p->templates.find(tree_name);
+    if (it != _p->templates.end())
+    {
+      return it->second.instantiate(blackboard);
+    }
+  }
   auto tree = _p->parser->instantiateTree(blackboard, tree_name);
-  tree.manifests = this->manifests();
+  tree.manifests = manifestsSnapshot();
   return tree;
 }
 
+TreeTemplate BehaviorTreeFactory::createTreeTemplate(const std::string& tree_name)
+{
+  if (_p->frozen)
+  {
+    auto it = _p->templates.find(tree_name);
+    if (it != _p->templates.end())
+    {
+      return it->second;
+    }
+  }
+  return _p->parser->createTreeTemplate(tree_name);
+}
+
+void BehaviorTreeFactory::freeze()
+{
+  if (_p->frozen)
+  {
+    return;
+  }
+  // from now on, manifestsSnapshot() and instantiateTreeNode()
+  // will not modify the factory
+  (void)manifestsSnapshot();
+  if (!_p->substitution_rules.empty())
+  {
+    _p->substitution_matcher =
+        std::make_unique<SubstitutionMatcher>(_p->substitution_rules);
+  }
+  for (const auto& tree_ID : _p->parser->registeredBehaviorTrees())
+  {
+    try
+    {
+      _p->templates.insert({tree_ID, _p->parser->createTreeTemplate(tree_ID)});
+    }
+    catch (std::exception&)
+    {
+      // not valid: createTree() will throw the same exception
+    }
+  }
+  _p->frozen = true;
+}
+
+bool BehaviorTreeFactory::frozen() const
+{
+  return _p->frozen;
+}
+
+std::shared_ptr<ScriptCache> BehaviorTreeFactory::scriptCache() const
+{
+  return _p->script_cache;
+}
+
+void BehaviorTreeFactory::setExecutor(std::shared_ptr<Executor> executor)
+{
+  _p->checkNotFrozen("setExecutor");
+  _p->executor = std::move(executor);
+}
+
+std::shared_ptr<Executor> BehaviorTreeFactory::executor() const
+{
+  return _p->executor;
+}
+
+void BehaviorTreeFactory::setCoroStackPoolOptions(CoroStackPool::Options options)
+{
+  _p->checkNotFrozen("setCoroStackPoolOptions");
+  _p->coro_stack_pool_options = std::move(options);
+}
+
+const CoroStackPool::Options& BehaviorTreeFactory::coroStackPoolOptions() const
+{
+  return _p->coro_stack_pool_options;
+}
+
+void BehaviorTreeFactory::enableNodeArena(bool enable)
+{
+  _p->checkNotFrozen("enableNodeArena");
+  _p->node_arena = enable;
+}
+
+bool BehaviorTreeFactory::nodeArenaEnabled() const
+{
+  return _p->node_arena;
+}
+
 void BehaviorTreeFactory::addMetadataToManifest(const std::string& node_id,
                                                 const KeyValueVector& metadata)
 {
+  _p->checkNotFrozen("addMetadataToManifest");
   auto it = _p->manifests.find(node_id);
   if (it == _p->manifests.end())
   {
     throw std::runtime_error("addMetadataToManifest: wrong ID");
   }
   it->second.metadata = metadata;
+  std::atomic_store(&_p->manifests_snapshot, {});
 }
 
 void BehaviorTreeFactory::registerScriptingEnum(StringView name, int value)
 {
+  _p->checkNotFrozen("registerScriptingEnum");
   (*_p->scripting_enums)[std::string(name)] = value;
 }
 
 void BehaviorTreeFactory::clearSubstitutionRules()
 {
+  _p->checkNotFrozen("clearSubstitutionRules");
   _p->substitution_rules.clear();
+  _p->substitution_matcher.reset();
 }
 
 void BehaviorTreeFactory::addSubstitutionRule(StringView filter, SubstitutionRule rule)
 {
+  _p->checkNotFrozen("addSubstitutionRule");
   _p->substitution_rules[std::string(filter)] = rule;
+  _p->substitution_matcher.reset();
 }
 
 void BehaviorTreeFactory::loadSubstitutionRuleFromJSON(const std::string &json_text)
@@ -511,7 +813,9 @@ Tree &Tree::operator=(Tree &&other)
 {
   subtrees = std::move(other.subtrees);
   manifests = std::move(other.manifests);
+  coro_stack_pool = std::move(other.coro_stack_pool);
   wake_up_ = other.wake_up_;
+  observed_nodes_ = other.observed_nodes_;
   return *this;
 }
 
@@ -526,11 +830,13 @@ Tree::Tree(Tree &&other)
 void Tree::initialize()
 {
   wake_up_ = std::make_shared<WakeUpSignal>();
+  observed_nodes_ = std::make_shared<std::atomic<size_t>>(0);
   for (auto& subtree : subtrees)
   {
     for (auto& node : subtree->nodes)
     {
       node->setWakeUpInstance(wake_up_);
+      node->setObservedNodesCounter(observed_nodes_);
     }
   }
 }
@@ -587,6 +893,11 @@ NodeStatus Tree::tickWhileRunning(std::chrono::milliseconds sleep_time)
   return tickRoot(WHILE_RUNNING, sleep_time);
 }
 
+bool Tree::observersAttached() const
+{
+  return observed_nodes_ && observed_nodes_->load(std::memory_order_relaxed) > 0;
+}
+
 Blackboard::Ptr Tree::rootBlackboard()
 {
   if (subtrees.size() > 0)
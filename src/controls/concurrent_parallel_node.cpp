@@ -0,0 +1,273 @@
+/* Copyright (C) 2024 Davide Faconti -  All Rights Reserved
+*
+*   Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+*   to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+*   and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*   The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include "behaviortree_cpp/controls/concurrent_parallel_node.h"
+
+namespace BT
+{
+
+// A task of the executor may start after the tick that created it returned
+// (if the tick thread ran the child itself): it must not use the node,
+// unless it is the first one to claim the child.
+struct ConcurrentParallelNode::Dispatch
+{
+  std::vector<size_t> indexes;
+  std::unique_ptr<std::atomic_bool[]> claimed;
+  size_t capacity = 0;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t pending = 0;
+
+  void reset(const std::vector<size_t>& children)
+  {
+    indexes = children;
+    if (capacity < indexes.size())
+    {
+      capacity = indexes.size();
+      claimed = std::make_unique<std::atomic_bool[]>(capacity);
+    }
+    for (size_t i = 0; i < indexes.size(); i++)
+    {
+      claimed[i] = false;
+    }
+    pending = indexes.size();
+  }
+
+  bool claim(size_t slot)
+  {
+    return !claimed[slot].exchange(true);
+  }
+};
+
+ConcurrentParallelNode::ConcurrentParallelNode(const std::string& name,
+                                               const NodeConfig& config) :
+  ControlNode::ControlNode(name, config),
+  failure_threshold_(1)
+{}
+
+void ConcurrentParallelNode::tickChild(size_t index)
+{
+  try
+  {
+    statuses_[index] = children_nodes_[index]->executeTick();
+  }
+  catch (...)
+  {
+    exceptions_[index] = std::current_exception();
+  }
+}
+
+void ConcurrentParallelNode::runDispatched(Dispatch& dispatch, size_t slot)
+{
+  tickChild(dispatch.indexes[slot]);
+  std::unique_lock lk(dispatch.mutex);
+  if (--dispatch.pending == 0)
+  {
+    dispatch.cv.notify_all();
+  }
+}
+
+NodeStatus ConcurrentParallelNode::tick()
+{
+  int max_failures = 0;
+  if (!getInput("max_failures", max_failures))
+  {
+    throw RuntimeError("Missing parameter [max_failures] in ConcurrentParallelNode");
+  }
+  const size_t children_count = children_nodes_.size();
+  setFailureThreshold(max_failures);
+
+  if (children_count < failure_threshold_)
+  {
+    throw LogicError("Number of children is less than threshold. Can never fail.");
+  }
+
+  std::vector<int> tick_thread_indexes;
+  if (auto res = getInput<std::vector<int>>("tick_thread_children"))
+  {
+    tick_thread_indexes = std::move(res.value());
+  }
+
+  if (completed_.size() != children_count)
+  {
+    completed_.assign(children_count, false);
+    completed_count_ = 0;
+  }
+  statuses_.assign(children_count, NodeStatus::IDLE);
+  exceptions_.assign(children_count, nullptr);
+
+  concurrent_children_.clear();
+  tick_thread_children_.clear();
+  for (size_t index = 0; index < children_count; index++)
+  {
+    if (completed_[index])
+    {
+      continue;
+    }
+    const bool tick_thread = std::find(tick_thread_indexes.begin(),
+                                       tick_thread_indexes.end(),
+                                       int(index)) != tick_thread_indexes.end();
+    (tick_thread ? tick_thread_children_ : concurrent_children_).push_back(index);
+  }
+
+  setStatus(NodeStatus::RUNNING);
+
+  if (concurrent_children_.size() > 1 && !executor_)
+  {
+    executor_ = config().executor;
+    if (!executor_)
+    {
+      executor_ = ThreadPool::defaultPool();
+    }
+  }
+  // The first concurrent child is ticked by this thread, after dispatching the others
+  if (concurrent_children_.size() > 1)
+  {
+    // reuse the previous Dispatch, unless a task still refers to it
+    if (!dispatch_ || dispatch_.use_count() > 1)
+    {
+      dispatch_ = std::make_shared<Dispatch>();
+    }
+    dispatch_->reset(concurrent_children_);
+    dispatch_->claim(0);
+    for (size_t slot = 1; slot < concurrent_children_.size(); slot++)
+    {
+      executor_->execute([this, dispatch = dispatch_, slot]() {
+        if (dispatch->claim(slot))
+        {
+          runDispatched(*dispatch, slot);
+        }
+      });
+    }
+    runDispatched(*dispatch_, 0);
+  }
+  else if (!concurrent_children_.empty())
+  {
+    tickChild(concurrent_children_.front());
+  }
+  for (size_t index : tick_thread_children_)
+  {
+    tickChild(index);
+  }
+  if (concurrent_children_.size() > 1)
+  {
+    // run the children that the executor didn't start yet
+    for (size_t slot = 1; slot < concurrent_children_.size(); slot++)
+    {
+      if (dispatch_->claim(slot))
+      {
+        runDispatched(*dispatch_, slot);
+      }
+    }
+    std::unique_lock lk(dispatch_->mutex);
+    dispatch_->cv.wait(lk, [this] { return dispatch_->pending == 0; });
+  }
+
+  for (const auto& exception : exceptions_)
+  {
+    if (exception)
+    {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  size_t skipped_count = 0;
+  for (size_t index = 0; index < children_count; index++)
+  {
+    if (completed_[index])
+    {
+      continue;
+    }
+    switch (statuses_[index])
+    {
+      case NodeStatus::SUCCESS: {
+        completed_[index] = true;
+        completed_count_++;
+      }
+      break;
+
+      case NodeStatus::FAILURE: {
+        completed_[index] = true;
+        completed_count_++;
+        failure_count_++;
+      }
+      break;
+
+      case NodeStatus::RUNNING: {
+        // Still working
+      }
+      break;
+
+      case NodeStatus::SKIPPED: {
+        skipped_count++;
+      }
+      break;
+
+      case NodeStatus::IDLE: {
+        throw LogicError("[", name(), "]: A children should not return IDLE");
+      }
+    }
+  }
+
+  if (skipped_count == children_count)
+  {
+    return NodeStatus::SKIPPED;
+  }
+  if (skipped_count + completed_count_ >= children_count)
+  {
+    // DONE
+    haltChildren();
+    completed_.assign(children_count, false);
+    completed_count_ = 0;
+    auto const status = (failure_count_ >= failure_threshold_) ? NodeStatus::FAILURE :
+                                                                 NodeStatus::SUCCESS;
+    failure_count_ = 0;
+    return status;
+  }
+
+  // Some children haven't finished, yet.
+  return NodeStatus::RUNNING;
+}
+
+void ConcurrentParallelNode::halt()
+{
+  completed_.assign(completed_.size(), false);
+  completed_count_ = 0;
+  failure_count_ = 0;
+  ControlNode::halt();
+}
+
+size_t ConcurrentParallelNode::failureThreshold() const
+{
+  return failure_threshold_;
+}
+
+void ConcurrentParallelNode::setFailureThreshold(int threshold)
+{
+  if (threshold < 0)
+  {
+    failure_threshold_ = size_t(std::max(int(children_nodes_.size()) + threshold + 1, 0));
+  }
+  else
+  {
+    failure_threshold_ = size_t(threshold);
+  }
+}
+
+}   // namespace BT
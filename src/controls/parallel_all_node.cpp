@@ -41,6 +41,7 @@ NodeStatus ParallelAllNode::tick()
   }
 
   setStatus(NodeStatus::RUNNING);
+  completed_list_.resize(children_count, false);
 
   // Routing the tree according to the sequence node's logic:
   for (size_t index = 0; index < children_count; index++)
@@ -48,7 +49,7 @@ NodeStatus ParallelAllNode::tick()
     TreeNode* child_node = children_nodes_[index];
 
     // already completed
-    if(completed_list_.count(index) != 0)
+    if(completed_list_[index])
     {
       continue;
     }
@@ -58,12 +59,14 @@ NodeStatus ParallelAllNode::tick()
     switch (child_status)
     {
       case NodeStatus::SUCCESS: {
-        completed_list_.insert(index);
+        completed_list_[index] = true;
+        completed_count_++;
       }
       break;
 
       case NodeStatus::FAILURE: {
-        completed_list_.insert(index);
+        completed_list_[index] = true;
+        completed_count_++;
         failure_count_++;
       }
       break;
@@ -88,11 +91,11 @@ NodeStatus ParallelAllNode::tick()
   {
     return NodeStatus::SKIPPED;
   }
-  if( skipped_count + completed_list_.size() >= children_count)
+  if( skipped_count + completed_count_ >= children_count)
   {
     // DONE
     haltChildren();
-    completed_list_.clear();
+    clear();
     auto const status = (failure_count_ >= failure_threshold_) ?
                             NodeStatus::FAILURE : NodeStatus::SUCCESS;
     failure_count_ = 0;
@@ -105,11 +108,17 @@ NodeStatus ParallelAllNode::tick()
 
 void ParallelAllNode::halt()
 {
-  completed_list_.clear();
+  clear();
   failure_count_ = 0;
   ControlNode::halt();
 }
 
+void ParallelAllNode::clear()
+{
+  std::fill(completed_list_.begin(), completed_list_.end(), false);
+  completed_count_ = 0;
+}
+
 
 size_t ParallelAllNode::failureThreshold() const
 {
@@ -65,13 +65,14 @@ NodeStatus ParallelNode::tick()
   }
 
   setStatus(NodeStatus::RUNNING);
+  completed_list_.resize(children_count, false);
 
   size_t skipped_count = 0;
 
   // Routing the tree according to the sequence node's logic:
   for (size_t i = 0; i < children_count; i++)
   {
-    if(completed_list_.count(i) == 0)
+    if(!completed_list_[i])
     {
       TreeNode* child_node = children_nodes_[i];
       NodeStatus const child_status = child_node->executeTick();
@@ -83,13 +84,13 @@ NodeStatus ParallelNode::tick()
         } break;
 
         case NodeStatus::SUCCESS: {
-          completed_list_.insert(i);
+          completed_list_[i] = true;
           success_count_++;
         }
         break;
 
         case NodeStatus::FAILURE: {
-          completed_list_.insert(i);
+          completed_list_[i] = true;
           failure_count_++;
         }
         break;
@@ -131,7 +132,7 @@ NodeStatus ParallelNode::tick()
 
 void ParallelNode::clear()
 {
-  completed_list_.clear();
+  std::fill(completed_list_.begin(), completed_list_.end(), false);
   success_count_ = 0;
   failure_count_ = 0;
 }
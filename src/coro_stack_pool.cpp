@@ -0,0 +1,122 @@
+#include "behaviortree_cpp/utils/coro_stack_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace BT
+{
+
+namespace
+{
+// The size of the block is stored right before the memory given to the user,
+// because minicoro doesn't pass it to the deallocation function.
+constexpr size_t HeaderSize = alignof(std::max_align_t);
+
+constexpr uint64_t StackPattern = 0xA5A5A5A5A5A5A5A5ull;
+
+void paint(void* begin, size_t size)
+{
+  auto words = static_cast<uint64_t*>(begin);
+  std::fill(words, words + size / sizeof(uint64_t), StackPattern);
+}
+}   // namespace
+
+CoroStackPool::CoroStackPool() : CoroStackPool(Options())
+{}
+
+CoroStackPool::CoroStackPool(Options options) : options_(std::move(options))
+{}
+
+CoroStackPool::~CoroStackPool()
+{
+  for (auto& [size, blocks] : free_blocks_)
+  {
+    for (void* block : blocks)
+    {
+      ::operator delete(block);
+    }
+  }
+}
+
+size_t CoroStackPool::stackSize(const std::string& registration_ID) const
+{
+  auto it = options_.stack_sizes.find(registration_ID);
+  return (it != options_.stack_sizes.end()) ? it->second : options_.default_stack_size;
+}
+
+void* CoroStackPool::allocate(size_t size)
+{
+  {
+    std::unique_lock lk(mutex_);
+    auto it = free_blocks_.find(size);
+    if (it != free_blocks_.end() && !it->second.empty())
+    {
+      void* block = it->second.back();
+      it->second.pop_back();
+      stats_.reused_blocks++;
+      stats_.cached_blocks--;
+      stats_.cached_bytes -= size;
+      return static_cast<char*>(block) + HeaderSize;
+    }
+    stats_.allocated_blocks++;
+  }
+
+  void* block = ::operator new(size + HeaderSize);
+  *static_cast<size_t*>(block) = size;
+  void* ptr = static_cast<char*>(block) + HeaderSize;
+  if (options_.measure_stack_usage)
+  {
+    paint(ptr, size);
+  }
+  return ptr;
+}
+
+void CoroStackPool::deallocate(void* ptr)
+{
+  if (!ptr)
+  {
+    return;
+  }
+  void* block = static_cast<char*>(ptr) - HeaderSize;
+  const size_t size = *static_cast<size_t*>(block);
+
+  std::unique_lock lk(mutex_);
+  free_blocks_[size].push_back(block);
+  stats_.cached_blocks++;
+  stats_.cached_bytes += size;
+}
+
+void CoroStackPool::recordStackUsage(const std::string& registration_ID,
+                                     void* stack_base, size_t stack_size)
+{
+  if (!options_.measure_stack_usage)
+  {
+    return;
+  }
+  // The stack grows downward: the words at the bottom that still contain
+  // the pattern were never used.
+  auto words = static_cast<const uint64_t*>(stack_base);
+  const size_t words_count = stack_size / sizeof(uint64_t);
+  size_t unused = 0;
+  while (unused < words_count && words[unused] == StackPattern)
+  {
+    unused++;
+  }
+  const size_t used_bytes = (words_count - unused) * sizeof(uint64_t);
+
+  // restore the pattern, for the next user of this block
+  paint(static_cast<uint64_t*>(stack_base) + unused, used_bytes);
+
+  std::unique_lock lk(mutex_);
+  auto& high_water = stats_.stack_high_water[registration_ID];
+  high_water = std::max(high_water, used_bytes);
+}
+
+CoroStackPool::Stats CoroStackPool::stats() const
+{
+  std::unique_lock lk(mutex_);
+  return stats_;
+}
+
+}   // namespace BT
@@ -33,6 +33,8 @@ NodeStatus TimeoutNode::tick()
 
     if (msec_ > 0)
     {
+      // The handler runs in the timer thread shared by all the nodes:
+      // it must not block, therefore the child is halted by the next tick.
       timer_id_ = timer_.add(std::chrono::milliseconds(msec_), [this](bool aborted) {
         // Return immediately if the timer was aborted.
         // This function could be invoked during destruction of this object and
@@ -41,22 +43,19 @@ NodeStatus TimeoutNode::tick()
         {
           return;
         }
-        std::unique_lock<std::mutex> lk(timeout_mutex_);
         if (child()->status() == NodeStatus::RUNNING)
         {
           child_halted_ = true;
-          haltChild();
           emitWakeUpSignal();
         }
       });
     }
   }
 
-  std::unique_lock<std::mutex> lk(timeout_mutex_);
-
   if (child_halted_)
   {
     timeout_started_ = false;
+    haltChild();
     return NodeStatus::FAILURE;
   }
   else
@@ -65,9 +64,7 @@ NodeStatus TimeoutNode::tick()
     if(isStatusCompleted(child_status))
     {
       timeout_started_ = false;
-      timeout_mutex_.unlock();
       timer_.cancel(timer_id_);
-      timeout_mutex_.lock();
       resetChild();
     }
     return child_status;
@@ -2,12 +2,32 @@
 #include "behaviortree_cpp/xml_parsing.h"
 #include "cpp-sqlite/sqlite.hpp"
 
+#include <iostream>
+
 namespace BT {
 
+namespace {
+
+SqliteLogger::Options OptionsAppend(bool append)
+{
+  SqliteLogger::Options options;
+  options.append = append;
+  return options;
+}
+
+}
+
 SqliteLogger::SqliteLogger(const Tree &tree,
                            std::filesystem::path const& filepath,
                            bool append):
-  StatusChangeLogger(tree.rootNode())
+  SqliteLogger(tree, filepath, OptionsAppend(append))
+{}
+
+SqliteLogger::SqliteLogger(const Tree &tree,
+                           std::filesystem::path const& filepath,
+                           const Options& options):
+  StatusChangeLogger(tree.rootNode()),
+  options_(options)
 {
   const auto extension = filepath.filename().extension();
   if( extension!= ".db3" && extension != ".btdb")
@@ -17,8 +37,25 @@ SqliteLogger::SqliteLogger(const Tree &tree,
 
   enableTransitionToIdle(true);
 
+  const auto& sync = options_.synchronous;
+  if( !sync.empty() && sync != "OFF" && sync != "NORMAL" &&
+      sync != "FULL" && sync != "EXTRA")
+  {
+    throw RuntimeError("SqliteLogger: invalid value of synchronous [", sync,
+                       "]. Use OFF, NORMAL, FULL or EXTRA");
+  }
+
   db_ = std::make_unique<sqlite::Connection>(filepath.string());
 
+  if( options_.wal_mode )
+  {
+    sqlite::Statement(*db_, "PRAGMA journal_mode=WAL;");
+  }
+  if( !sync.empty() )
+  {
+    sqlite::Statement(*db_, "PRAGMA synchronous=" + sync + ";");
+  }
+
   sqlite::Statement(*db_,
                     "CREATE TABLE IF NOT EXISTS Transitions ("
                     "timestamp  INTEGER PRIMARY KEY NOT NULL, "
@@ -33,7 +70,7 @@ SqliteLogger::SqliteLogger(const Tree &tree,
                     "date       TEXT NOT NULL,"
                     "xml_tree   TEXT NOT NULL);");
 
-  if( !append )
+  if( !options_.append )
   {
     sqlite::Statement(*db_, "DELETE from Transitions;");
     sqlite::Statement(*db_, "DELETE from Definitions;");
@@ -58,6 +95,7 @@ SqliteLogger::~SqliteLogger()
 {
   loop_ = false;
   queue_cv_.notify_one();
+  queue_space_cv_.notify_all();
   writer_thread_.join();
   flush();
   sqlite::Statement(*db_, "PRAGMA optimize;");
@@ -97,7 +135,26 @@ void SqliteLogger::callback(Duration timestamp,
   trans.status = status;
 
   {
-    std::scoped_lock lk(queue_mutex_);
+    std::unique_lock lk(queue_mutex_);
+    const auto max_size = options_.max_queue_size;
+    if( max_size > 0 && transitions_queue_.size() >= max_size )
+    {
+      switch(options_.overflow_policy)
+      {
+        case OverflowPolicy::BLOCK:
+          queue_space_cv_.wait(lk, [this, max_size]() {
+            return transitions_queue_.size() < max_size || !loop_;
+          });
+          break;
+        case OverflowPolicy::DROP_NEWEST:
+          dropped_transitions_++;
+          return;
+        case OverflowPolicy::DROP_OLDEST:
+          dropped_transitions_++;
+          transitions_queue_.pop_front();
+          break;
+      }
+    }
     transitions_queue_.push_back(trans);
   }
   queue_cv_.notify_one();
@@ -107,7 +164,14 @@ void SqliteLogger::writerLoop()
 {
   std::deque<Transition> transitions;
 
-  while(loop_)
+  // prepare the statements only once
+  sqlite::Priv::Statement begin_stmt(*db_, "BEGIN TRANSACTION;");
+  sqlite::Priv::Statement commit_stmt(*db_, "COMMIT;");
+  sqlite::Priv::Statement rollback_stmt(*db_, "ROLLBACK;");
+  sqlite::Priv::Statement insert_stmt(*db_,
+                                      "INSERT INTO Transitions VALUES (?, ?, ?, ?, ?)");
+
+  while(true)
   {
     transitions.clear();
     {
@@ -117,20 +181,46 @@ void SqliteLogger::writerLoop()
       });
       std::swap(transitions, transitions_queue_);
     }
+    queue_space_cv_.notify_all();
+
+    // when stopping, exit only once the queue has been drained
+    if(transitions.empty())
+    {
+      break;
+    }
 
-    while(!transitions.empty())
+    // a single transaction (and journal sync) for the entire batch
+    try
+    {
+      (void)begin_stmt.Advance();
+      for(const auto& trans: transitions)
+      {
+        sqlite::Priv::AppendToQuery(insert_stmt.handle, 1,
+                                    trans.timestamp,
+                                    int64_t(session_id_),
+                                    int32_t(trans.node_uid),
+                                    trans.duration,
+                                    static_cast<int>(trans.status));
+        (void)insert_stmt.Advance();
+      }
+      (void)commit_stmt.Advance();
+    }
+    catch(std::exception& ex)
     {
-      auto const trans = transitions.front();
-      transitions.pop_front();
-
-      sqlite::Statement(
-          *db_,
-          "INSERT INTO Transitions VALUES (?, ?, ?, ?, ?)",
-          trans.timestamp,
-          session_id_,
-          trans.node_uid,
-          trans.duration,
-          static_cast<int>(trans.status));
+      // the statements that failed must be reset before being used again
+      sqlite3_reset(begin_stmt.handle);
+      sqlite3_reset(insert_stmt.handle);
+      sqlite3_reset(commit_stmt.handle);
+      // still inside the transaction: roll it back
+      if(sqlite3_get_autocommit(db_->GetPtr()) == 0)
+      {
+        sqlite3_reset(rollback_stmt.handle);
+        sqlite3_step(rollback_stmt.handle);
+        sqlite3_reset(rollback_stmt.handle);
+      }
+      dropped_transitions_ += transitions.size();
+      std::cerr << "SqliteLogger: failed to write " << transitions.size()
+                << " transitions: " << ex.what() << std::endl;
     }
   }
 }
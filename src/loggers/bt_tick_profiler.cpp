@@ -0,0 +1,325 @@
+#include "behaviortree_cpp/loggers/bt_tick_profiler.h"
+#include "behaviortree_cpp/decorator_node.h"
+#include "behaviortree_cpp/control_node.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <iomanip>
+#include <unordered_map>
+
+namespace BT
+{
+
+struct TickProfiler::PImpl
+{
+  struct NodeInfo
+  {
+    // the profiler may outlive the tree
+    std::weak_ptr<TreeNode> node;
+    uint16_t uid = 0;
+    std::string name;
+    std::string path;
+    std::string registration_name;
+  };
+
+  // the nodes and their parents (-1 for the root), by index
+  std::vector<NodeInfo> nodes;
+  std::vector<int> parents;
+  std::vector<int> index_by_uid;
+
+  // Flat arrays, one element per node (BucketsCount for the histograms).
+  // Each node is ticked by one thread at a time: only children_ns is
+  // written by multiple threads (the children of ConcurrentParallel).
+  std::unique_ptr<std::atomic<uint64_t>[]> ticks;
+  std::unique_ptr<std::atomic<uint64_t>[]> inclusive_total;
+  std::unique_ptr<std::atomic<uint64_t>[]> inclusive_max;
+  std::unique_ptr<std::atomic<uint64_t>[]> self_total;
+  std::unique_ptr<std::atomic<uint64_t>[]> self_max;
+  std::unique_ptr<std::atomic<uint64_t>[]> children_ns;
+  std::unique_ptr<std::atomic<uint64_t>[]> inclusive_histogram;
+  std::unique_ptr<std::atomic<uint64_t>[]> self_histogram;
+
+  void allocate()
+  {
+    const size_t size = nodes.size();
+    for (auto array : {&ticks, &inclusive_total, &inclusive_max, &self_total, &self_max,
+                       &children_ns})
+    {
+      *array = std::make_unique<std::atomic<uint64_t>[]>(size);
+    }
+    inclusive_histogram = std::make_unique<std::atomic<uint64_t>[]>(size * BucketsCount);
+    self_histogram = std::make_unique<std::atomic<uint64_t>[]>(size * BucketsCount);
+  }
+
+  // single writer: no need of an atomic read-modify-write
+  static void add(std::atomic<uint64_t>& counter, uint64_t value)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  }
+
+  static void max(std::atomic<uint64_t>& counter, uint64_t value)
+  {
+    if (value > counter.load(std::memory_order_relaxed))
+    {
+      counter.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  static size_t bucket(uint64_t nanoseconds)
+  {
+    return std::min<size_t>(std::bit_width(nanoseconds), BucketsCount - 1);
+  }
+
+  void record(int index, std::chrono::nanoseconds duration)
+  {
+    const uint64_t inclusive = uint64_t(std::max<int64_t>(duration.count(), 0));
+    const uint64_t children = children_ns[index].exchange(0, std::memory_order_relaxed);
+    // the children of ConcurrentParallel may overlap
+    const uint64_t self = (inclusive > children) ? inclusive - children : 0;
+    if (parents[index] >= 0)
+    {
+      children_ns[parents[index]].fetch_add(inclusive, std::memory_order_relaxed);
+    }
+    add(ticks[index], 1);
+    add(inclusive_total[index], inclusive);
+    max(inclusive_max[index], inclusive);
+    add(inclusive_histogram[index * BucketsCount + bucket(inclusive)], 1);
+    add(self_total[index], self);
+    max(self_max[index], self);
+    add(self_histogram[index * BucketsCount + bucket(self)], 1);
+  }
+
+  NodeStatistics statistics(size_t index) const
+  {
+    NodeStatistics stats;
+    const NodeInfo& node = nodes[index];
+    stats.uid = node.uid;
+    stats.path = node.path;
+    stats.registration_name = node.registration_name;
+    stats.ticks = ticks[index];
+    stats.inclusive_total = std::chrono::nanoseconds(inclusive_total[index]);
+    stats.inclusive_max = std::chrono::nanoseconds(inclusive_max[index]);
+    stats.self_total = std::chrono::nanoseconds(self_total[index]);
+    stats.self_max = std::chrono::nanoseconds(self_max[index]);
+    for (size_t b = 0; b < BucketsCount; b++)
+    {
+      stats.inclusive_histogram[b] = inclusive_histogram[index * BucketsCount + b];
+      stats.self_histogram[b] = self_histogram[index * BucketsCount + b];
+    }
+    return stats;
+  }
+};
+
+std::chrono::nanoseconds TickProfiler::percentile(const Histogram& histogram,
+                                                  double percentile)
+{
+  uint64_t total = 0;
+  for (auto count : histogram)
+  {
+    total += count;
+  }
+  if (total == 0)
+  {
+    return {};
+  }
+  const double threshold = total * std::clamp(percentile, 0.0, 100.0) / 100.0;
+  uint64_t accumulated = 0;
+  for (size_t b = 0; b < BucketsCount; b++)
+  {
+    accumulated += histogram[b];
+    if (accumulated > 0 && double(accumulated) >= threshold)
+    {
+      return std::chrono::nanoseconds(b == 0 ? 0 : (uint64_t(1) << b) - 1);
+    }
+  }
+  return std::chrono::nanoseconds((uint64_t(1) << (BucketsCount - 1)) - 1);
+}
+
+TickProfiler::TickProfiler(const Tree& tree) : _p(new PImpl)
+{
+  std::unordered_map<const TreeNode*, int> index_by_node;
+  std::vector<TreeNode*> nodes;
+  for (const auto& subtree : tree.subtrees)
+  {
+    for (const auto& node : subtree->nodes)
+    {
+      index_by_node[node.get()] = int(nodes.size());
+      nodes.push_back(node.get());
+      _p->nodes.push_back({node, node->UID(), node->name(), node->fullPath(),
+                           node->registrationName()});
+    }
+  }
+  _p->parents.resize(nodes.size(), -1);
+
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    const TreeNode* node = nodes[i];
+    if (auto control = dynamic_cast<const ControlNode*>(node))
+    {
+      for (const auto& child : control->children())
+      {
+        _p->parents[index_by_node.at(child)] = int(i);
+      }
+    }
+    else if (auto decorator = dynamic_cast<const DecoratorNode*>(node))
+    {
+      if (decorator->child())
+      {
+        _p->parents[index_by_node.at(decorator->child())] = int(i);
+      }
+    }
+    if (_p->index_by_uid.size() <= node->UID())
+    {
+      _p->index_by_uid.resize(node->UID() + 1, -1);
+    }
+    _p->index_by_uid[node->UID()] = int(i);
+  }
+  _p->allocate();
+
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    PImpl* p = _p.get();
+    const int index = int(i);
+    nodes[i]->setTickMonitorCallback(
+        [p, index](TreeNode&, NodeStatus, std::chrono::nanoseconds duration) {
+          p->record(index, duration);
+        });
+  }
+}
+
+TickProfiler::~TickProfiler()
+{
+  for (const auto& info : _p->nodes)
+  {
+    if (auto node = info.node.lock())
+    {
+      node->setTickMonitorCallback({});
+    }
+  }
+}
+
+void TickProfiler::reset()
+{
+  const size_t size = _p->nodes.size();
+  for (size_t i = 0; i < size; i++)
+  {
+    for (auto array : {&_p->ticks, &_p->inclusive_total, &_p->inclusive_max,
+                       &_p->self_total, &_p->self_max, &_p->children_ns})
+    {
+      (*array)[i] = 0;
+    }
+  }
+  for (size_t i = 0; i < size * BucketsCount; i++)
+  {
+    _p->inclusive_histogram[i] = 0;
+    _p->self_histogram[i] = 0;
+  }
+}
+
+std::vector<TickProfiler::NodeStatistics> TickProfiler::statistics() const
+{
+  std::vector<NodeStatistics> output;
+  output.reserve(_p->nodes.size());
+  for (size_t i = 0; i < _p->nodes.size(); i++)
+  {
+    output.push_back(_p->statistics(i));
+  }
+  return output;
+}
+
+TickProfiler::NodeStatistics TickProfiler::statistics(uint16_t uid) const
+{
+  if (uid >= _p->index_by_uid.size() || _p->index_by_uid[uid] < 0)
+  {
+    throw RuntimeError("TickProfiler: invalid UID ", std::to_string(uid));
+  }
+  return _p->statistics(size_t(_p->index_by_uid[uid]));
+}
+
+void TickProfiler::writeTable(std::ostream& os) const
+{
+  auto usec = [](std::chrono::nanoseconds ns) { return double(ns.count()) / 1000.0; };
+
+  const auto all_stats = statistics();
+  size_t path_width = 4;
+  for (const auto& stats : all_stats)
+  {
+    path_width = std::max(path_width, stats.path.size());
+  }
+
+  os << std::left << std::setw(int(path_width)) << "path" << std::right
+     << std::setw(10) << "ticks" << std::setw(14) << "incl_total" << std::setw(12)
+     << "incl_mean" << std::setw(12) << "incl_p99" << std::setw(12) << "incl_max"
+     << std::setw(14) << "self_total" << std::setw(12) << "self_mean" << std::setw(12)
+     << "self_max" << "\n";
+
+  os << std::fixed << std::setprecision(1);
+  for (const auto& stats : all_stats)
+  {
+    const double ticks = double(std::max<uint64_t>(stats.ticks, 1));
+    os << std::left << std::setw(int(path_width)) << stats.path << std::right
+       << std::setw(10) << stats.ticks << std::setw(14) << usec(stats.inclusive_total)
+       << std::setw(12) << usec(stats.inclusive_total) / ticks << std::setw(12)
+       << usec(percentile(stats.inclusive_histogram, 99)) << std::setw(12)
+       << usec(stats.inclusive_max) << std::setw(14) << usec(stats.self_total)
+       << std::setw(12) << usec(stats.self_total) / ticks << std::setw(12)
+       << usec(stats.self_max) << "\n";
+  }
+  os << std::defaultfloat;
+}
+
+nlohmann::json TickProfiler::toJson() const
+{
+  nlohmann::json nodes = nlohmann::json::array();
+  for (const auto& stats : statistics())
+  {
+    nlohmann::json node;
+    node["uid"] = stats.uid;
+    node["path"] = stats.path;
+    node["registration_name"] = stats.registration_name;
+    node["ticks"] = stats.ticks;
+    node["inclusive"] = {{"total_ns", stats.inclusive_total.count()},
+                         {"max_ns", stats.inclusive_max.count()},
+                         {"histogram", stats.inclusive_histogram}};
+    node["self"] = {{"total_ns", stats.self_total.count()},
+                    {"max_ns", stats.self_max.count()},
+                    {"histogram", stats.self_histogram}};
+    nodes.push_back(std::move(node));
+  }
+  nlohmann::json output;
+  output["buckets_count"] = BucketsCount;
+  output["nodes"] = std::move(nodes);
+  return output;
+}
+
+void TickProfiler::writeFoldedStacks(std::ostream& os) const
+{
+  const size_t size = _p->nodes.size();
+
+  std::vector<std::string> stacks(size);
+  std::function<const std::string&(size_t)> getStack = [&](size_t i) -> const std::string& {
+    if (stacks[i].empty())
+    {
+      std::string name = _p->nodes[i].name;
+      std::replace(name.begin(), name.end(), ';', '_');
+      std::replace(name.begin(), name.end(), ' ', '_');
+      const int parent = _p->parents[i];
+      stacks[i] = (parent >= 0) ? getStack(size_t(parent)) + ";" + name : name;
+    }
+    return stacks[i];
+  };
+
+  for (size_t i = 0; i < size; i++)
+  {
+    const uint64_t self_usec = _p->self_total[i] / 1000;
+    if (self_usec > 0)
+    {
+      os << getStack(i) << " " << self_usec << "\n";
+    }
+  }
+}
+
+}   // namespace BT
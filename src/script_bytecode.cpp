@@ -0,0 +1,643 @@
+#include "behaviortree_cpp/scripting/bytecode.hpp"
+#include "behaviortree_cpp/scripting/operators.hpp"
+
+#include <optional>
+
+namespace BT::Ast
+{
+
+class ProgramCompiler
+{
+public:
+  ProgramCompiler(Program& program) : program_(program)
+  {}
+
+  // Return the operand containing the value of the expression.
+  // If numeric is true, a variable that contains a number can be
+  // loaded as a double, instead of copying its Any.
+  uint32_t compile(const ExprBase& expr, bool numeric)
+  {
+    if (auto literal = dynamic_cast<const ExprLiteral*>(&expr))
+    {
+      return addConstant(literal->value);
+    }
+    if (auto name = dynamic_cast<const ExprName*>(&expr))
+    {
+      const uint32_t dst = addRegister();
+      emit({Program::OpCode::LOAD_VAR, uint8_t(numeric), dst, slot(name->name)});
+      return dst;
+    }
+    if (auto unary = dynamic_cast<const ExprUnaryArithmetic*>(&expr))
+    {
+      return compileUnary(*unary);
+    }
+    if (auto binary = dynamic_cast<const ExprBinaryArithmetic*>(&expr))
+    {
+      return compileBinary(*binary);
+    }
+    if (auto comparison = dynamic_cast<const ExprComparison*>(&expr))
+    {
+      return compileComparison(*comparison);
+    }
+    if (auto if_expr = dynamic_cast<const ExprIf*>(&expr))
+    {
+      return compileIf(*if_expr, numeric);
+    }
+    if (auto assignment = dynamic_cast<const ExprAssignment*>(&expr))
+    {
+      return compileAssignment(*assignment);
+    }
+    throw LogicError("ProgramCompiler: unknown expression");
+  }
+
+  void setResult(uint32_t operand)
+  {
+    program_.result_ = operand;
+  }
+
+private:
+  Program& program_;
+
+  static bool isConstant(uint32_t operand)
+  {
+    return (operand & Program::CONSTANT_BIT) != 0;
+  }
+
+  const Any& constant(uint32_t operand) const
+  {
+    return program_.constants_[operand & ~Program::CONSTANT_BIT].any;
+  }
+
+  uint32_t addConstant(const Any& value)
+  {
+    Program::Value constant;
+    constant.setAny(value);
+    if (value.isNumber())
+    {
+      constant.number = value.cast<double>();
+      constant.has_number = true;
+    }
+    program_.constants_.push_back(std::move(constant));
+    return uint32_t(program_.constants_.size() - 1) | Program::CONSTANT_BIT;
+  }
+
+  uint32_t addRegister()
+  {
+    return uint32_t(program_.registers_count_++);
+  }
+
+  uint32_t slot(const std::string& name)
+  {
+    auto& slots = program_.slots_;
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+      if (slots[i] == name)
+      {
+        return uint32_t(i);
+      }
+    }
+    slots.push_back(name);
+    return uint32_t(slots.size() - 1);
+  }
+
+  size_t emit(const Program::Instruction& instruction)
+  {
+    program_.instructions_.push_back(instruction);
+    return program_.instructions_.size() - 1;
+  }
+
+  // index of the next instruction, used as jump target
+  uint32_t here() const
+  {
+    return uint32_t(program_.instructions_.size());
+  }
+
+  // Evaluate at compilation time an expression made only of constants.
+  // Errors are not reported here: the expression will fail at run-time, instead.
+  template <typename Func>
+  std::optional<uint32_t> tryFold(Func&& func)
+  {
+    try
+    {
+      return addConstant(func());
+    }
+    catch (std::exception&)
+    {
+      return std::nullopt;
+    }
+  }
+
+  uint32_t compileUnary(const ExprUnaryArithmetic& expr)
+  {
+    const uint32_t rhs = compile(*expr.rhs, true);
+    if (isConstant(rhs))
+    {
+      if (auto folded =
+              tryFold([&] { return ExprUnaryArithmetic::apply(expr.op, constant(rhs)); }))
+      {
+        return *folded;
+      }
+    }
+    const uint32_t dst = addRegister();
+    emit({Program::OpCode::UNARY, uint8_t(expr.op), dst, rhs});
+    return dst;
+  }
+
+  uint32_t compileBinary(const ExprBinaryArithmetic& expr)
+  {
+    // bitwise and logic operators need the original type of the operands
+    const bool numeric = expr.op == ExprBinaryArithmetic::plus ||
+                         expr.op == ExprBinaryArithmetic::minus ||
+                         expr.op == ExprBinaryArithmetic::times ||
+                         expr.op == ExprBinaryArithmetic::div;
+    const uint32_t lhs = compile(*expr.lhs, numeric);
+    const uint32_t rhs = compile(*expr.rhs, numeric);
+    if (isConstant(lhs) && isConstant(rhs))
+    {
+      if (auto folded = tryFold([&] {
+            return ExprBinaryArithmetic::apply(expr.op, constant(lhs), constant(rhs));
+          }))
+      {
+        return *folded;
+      }
+    }
+    const uint32_t dst = addRegister();
+    emit({Program::OpCode::BINARY, uint8_t(expr.op), dst, lhs, rhs});
+    return dst;
+  }
+
+  uint32_t compileComparison(const ExprComparison& expr)
+  {
+    std::vector<uint32_t> operands;
+    operands.push_back(compile(*expr.operands[0], true));
+    const size_t first_instruction = here();
+    std::vector<size_t> compare_instructions;
+    const uint32_t dst = addRegister();
+
+    for (size_t i = 0; i < expr.ops.size(); i++)
+    {
+      operands.push_back(compile(*expr.operands[i + 1], true));
+      compare_instructions.push_back(emit({Program::OpCode::COMPARE, uint8_t(expr.ops[i]),
+                                           dst, operands[i], operands[i + 1]}));
+    }
+
+    bool all_constants = true;
+    for (auto operand : operands)
+    {
+      all_constants &= isConstant(operand);
+    }
+    if (all_constants)
+    {
+      auto folded = tryFold([&] {
+        for (size_t i = 0; i < expr.ops.size(); i++)
+        {
+          if (!ExprComparison::compare(expr.ops[i], constant(operands[i]),
+                                       constant(operands[i + 1])))
+          {
+            return Any(0.0);
+          }
+        }
+        return Any(1.0);
+      });
+      if (folded)
+      {
+        program_.instructions_.resize(first_instruction);
+        return *folded;
+      }
+    }
+
+    const uint32_t one = addConstant(Any(1.0));
+    emit({Program::OpCode::MOVE, 0, dst, one});
+    for (auto index : compare_instructions)
+    {
+      program_.instructions_[index].target = here();
+    }
+    return dst;
+  }
+
+  uint32_t compileIf(const ExprIf& expr, bool numeric)
+  {
+    const uint32_t condition = compile(*expr.condition, true);
+    if (isConstant(condition))
+    {
+      const Any& value = constant(condition);
+      std::optional<bool> is_true;
+      try
+      {
+        is_true = ExprIf::isTrue(value);
+      }
+      catch (std::exception&)
+      {}
+      if (is_true)
+      {
+        return compile(is_true.value() ? *expr.then : *expr.else_, numeric);
+      }
+    }
+
+    const uint32_t dst = addRegister();
+    const size_t jump_to_else = emit({Program::OpCode::JUMP_IF_FALSE, 0, 0, condition});
+
+    const uint32_t then_value = compile(*expr.then, numeric);
+    emit({Program::OpCode::MOVE, 0, dst, then_value});
+    const size_t jump_to_end = emit({Program::OpCode::JUMP});
+
+    program_.instructions_[jump_to_else].target = here();
+    const uint32_t else_value = compile(*expr.else_, numeric);
+    emit({Program::OpCode::MOVE, 0, dst, else_value});
+
+    program_.instructions_[jump_to_end].target = here();
+    return dst;
+  }
+
+  uint32_t compileAssignment(const ExprAssignment& expr)
+  {
+    const uint32_t dst = addRegister();
+    auto varname = dynamic_cast<const ExprName*>(expr.lhs.get());
+    if (!varname)
+    {
+      program_.messages_.push_back("Assignment left operand not a blackboard entry");
+      emit({Program::OpCode::FAIL, 0, 0, uint32_t(program_.messages_.size() - 1)});
+      return dst;
+    }
+    const uint32_t entry = slot(varname->name);
+    // the entry must be created before evaluating the right operand
+    emit({Program::OpCode::CREATE_ENTRY, uint8_t(expr.op), 0, entry});
+    const uint32_t value = compile(*expr.rhs, false);
+    emit({Program::OpCode::ASSIGN, uint8_t(expr.op), dst, entry, value});
+    return dst;
+  }
+};
+
+std::shared_ptr<const Program>
+Program::compile(const std::vector<std::shared_ptr<ExprBase>>& exprs,
+                 const std::string& source)
+{
+  auto program = std::make_shared<Program>();
+  program->source_ = source;
+  ProgramCompiler compiler(*program);
+  for (size_t i = 0; i < exprs.size(); i++)
+  {
+    const bool is_last = (i + 1 == exprs.size());
+    // the value of the last expression is returned as it is
+    const uint32_t operand = compiler.compile(*exprs[i], !is_last);
+    if (is_last)
+    {
+      compiler.setResult(operand);
+    }
+  }
+  return program;
+}
+
+//----------------------------------------------------------
+
+// The blackboard entries (or the enums) of the slots of a Program,
+// for a given Environment
+struct ProgramExecutor::SlotsCache
+{
+  struct Slot
+  {
+    std::shared_ptr<Blackboard::Entry> entry;
+    bool is_enum = false;
+    double enum_value = 0;
+  };
+
+  const Blackboard* blackboard = nullptr;
+  std::weak_ptr<Blackboard> blackboard_weak;
+  const EnumsTable* enums = nullptr;
+  uint64_t removed_entries = 0;
+  std::vector<Slot> slots;
+
+  bool isValid(const Environment& env) const
+  {
+    const Blackboard* bb = env.vars.get();
+    if (bb != blackboard || env.enums.get() != enums)
+    {
+      return false;
+    }
+    return !bb || (!blackboard_weak.expired() && bb->removedEntriesCount() == removed_entries);
+  }
+};
+
+namespace
+{
+// The state of a single execution of a Program
+struct Frame
+{
+  std::vector<Program::Value> registers;
+  std::vector<Blackboard::Entry*> entries;
+  // entries found or created during the execution (not in the cache)
+  std::vector<std::shared_ptr<Blackboard::Entry>> new_entries;
+};
+
+// One Frame for each nested execution in this thread, reused by the
+// following ones to avoid allocations.
+thread_local std::vector<std::unique_ptr<Frame>> frames_stack;
+thread_local size_t frames_depth = 0;
+
+class FrameScope
+{
+public:
+  FrameScope(size_t registers_count, size_t slots_count)
+  {
+    if (frames_depth == frames_stack.size())
+    {
+      frames_stack.push_back(std::make_unique<Frame>());
+    }
+    frame_ = frames_stack[frames_depth++].get();
+    frame_->registers.resize(registers_count);
+    frame_->entries.assign(slots_count, nullptr);
+  }
+
+  ~FrameScope()
+  {
+    frame_->new_entries.clear();
+    frames_depth--;
+  }
+
+  FrameScope(const FrameScope&) = delete;
+  FrameScope& operator=(const FrameScope&) = delete;
+
+  Frame& frame()
+  {
+    return *frame_;
+  }
+
+private:
+  Frame* frame_;
+};
+}   // namespace
+
+ProgramExecutor::ProgramExecutor(std::shared_ptr<const Program> program) :
+  program_(std::move(program))
+{}
+
+ProgramExecutor::ProgramExecutor(const ProgramExecutor& other) :
+  program_(other.program_), cache_(std::atomic_load(&other.cache_))
+{}
+
+ProgramExecutor& ProgramExecutor::operator=(const ProgramExecutor& other)
+{
+  if (this != &other)
+  {
+    program_ = other.program_;
+    std::atomic_store(&cache_, std::atomic_load(&other.cache_));
+  }
+  return *this;
+}
+
+Any ProgramExecutor::operator()(Environment& env) const
+{
+  try
+  {
+    return run(env);
+  }
+  catch (RuntimeError& err)
+  {
+    throw RuntimeError(StrCat("Error in script [", program_->source(), "]\n", err.what()));
+  }
+}
+
+std::shared_ptr<const ProgramExecutor::SlotsCache>
+ProgramExecutor::resolveSlots(Environment& env) const
+{
+  auto cache = std::atomic_load(&cache_);
+  if (cache && cache->isValid(env))
+  {
+    return cache;
+  }
+
+  auto new_cache = std::make_shared<SlotsCache>();
+  const Blackboard* blackboard = env.vars.get();
+  new_cache->blackboard = blackboard;
+  new_cache->blackboard_weak = env.vars;
+  new_cache->enums = env.enums.get();
+  new_cache->removed_entries = blackboard ? blackboard->removedEntriesCount() : 0;
+
+  const auto& names = program_->slots();
+  new_cache->slots.resize(names.size());
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    auto& slot = new_cache->slots[i];
+    if (env.enums)
+    {
+      auto it = env.enums->find(names[i]);
+      if (it != env.enums->end())
+      {
+        slot.is_enum = true;
+        slot.enum_value = double(it->second);
+      }
+    }
+    // may be null, if the entry wasn't created yet
+    slot.entry = blackboard ? env.vars->getEntry(names[i]) : nullptr;
+  }
+  std::atomic_store(&cache_, std::shared_ptr<const SlotsCache>(new_cache));
+  return new_cache;
+}
+
+Any ProgramExecutor::run(Environment& env) const
+{
+  using OpCode = Program::OpCode;
+  const auto& program = *program_;
+  const auto& instructions = program.instructions();
+  const auto& constants = program.constants();
+
+  // kept alive until the end of the execution
+  const auto cache = program.slots().empty() ? nullptr : resolveSlots(env);
+
+  FrameScope scope(program.registersCount(), program.slots().size());
+  Frame& frame = scope.frame();
+  auto& registers = frame.registers;
+  for (size_t i = 0; i < program.slots().size(); i++)
+  {
+    frame.entries[i] = cache->slots[i].entry.get();
+  }
+
+  auto operand = [&](uint32_t index) -> const Program::Value& {
+    return (index & Program::CONSTANT_BIT) ? constants[index & ~Program::CONSTANT_BIT] :
+                                             registers[index];
+  };
+
+  auto getEntry = [&](uint32_t index) -> Blackboard::Entry* {
+    auto& entry = frame.entries[index];
+    if (!entry && env.vars)
+    {
+      if (auto found = env.vars->getEntry(program.slots()[index]))
+      {
+        entry = found.get();
+        frame.new_entries.push_back(std::move(found));
+      }
+    }
+    return entry;
+  };
+
+  size_t pc = 0;
+  while (pc < instructions.size())
+  {
+    const auto& instr = instructions[pc];
+    switch (instr.code)
+    {
+      case OpCode::LOAD_VAR: {
+        auto& dst = registers[instr.dst];
+        const auto& slot = cache->slots[instr.a];
+        if (slot.is_enum)
+        {
+          dst.setNumber(slot.enum_value);
+          break;
+        }
+        auto entry = getEntry(instr.a);
+        if (!entry)
+        {
+          throw RuntimeError(StrCat("Variable not found: ", program.slots()[instr.a]));
+        }
+        std::unique_lock lk(entry->entry_mutex);
+        if (instr.op != 0 && entry->value.isNumber())
+        {
+          dst.setNumber(entry->value.cast<double>());
+        }
+        else
+        {
+          dst.setAny(entry->value);
+        }
+      }
+      break;
+
+      case OpCode::UNARY: {
+        const auto& rhs = operand(instr.a);
+        auto& dst = registers[instr.dst];
+        const auto op = ExprUnaryArithmetic::op_t(instr.op);
+        if (rhs.has_number)
+        {
+          switch (op)
+          {
+            case ExprUnaryArithmetic::negate:
+              dst.setNumber(-rhs.number);
+              break;
+            case ExprUnaryArithmetic::complement:
+              dst.setNumber(static_cast<double>(~static_cast<int64_t>(rhs.number)));
+              break;
+            case ExprUnaryArithmetic::logical_not:
+              dst.setNumber(static_cast<double>(!static_cast<bool>(rhs.number)));
+              break;
+          }
+        }
+        else
+        {
+          dst.setAny(ExprUnaryArithmetic::apply(op, rhs.toAny()));
+        }
+      }
+      break;
+
+      case OpCode::BINARY: {
+        const auto& lhs = operand(instr.a);
+        const auto& rhs = operand(instr.b);
+        auto& dst = registers[instr.dst];
+        const auto op = ExprBinaryArithmetic::op_t(instr.op);
+        if (lhs.has_number && rhs.has_number && op <= ExprBinaryArithmetic::div)
+        {
+          switch (op)
+          {
+            case ExprBinaryArithmetic::plus:
+              dst.setNumber(lhs.number + rhs.number);
+              break;
+            case ExprBinaryArithmetic::minus:
+              dst.setNumber(lhs.number - rhs.number);
+              break;
+            case ExprBinaryArithmetic::times:
+              dst.setNumber(lhs.number * rhs.number);
+              break;
+            default:
+              dst.setNumber(lhs.number / rhs.number);
+          }
+        }
+        else if (lhs.has_number && !lhs.has_any && rhs.has_number && !rhs.has_any &&
+                 (op == ExprBinaryArithmetic::logic_and ||
+                  op == ExprBinaryArithmetic::logic_or))
+        {
+          // both operands are double, for instance the result of a comparison
+          const bool lb = static_cast<bool>(lhs.number);
+          const bool rb = static_cast<bool>(rhs.number);
+          const bool result = (op == ExprBinaryArithmetic::logic_and) ? (lb && rb) : (lb || rb);
+          dst.setNumber(static_cast<double>(result));
+        }
+        else
+        {
+          dst.setAny(ExprBinaryArithmetic::apply(op, lhs.toAny(), rhs.toAny()));
+        }
+      }
+      break;
+
+      case OpCode::COMPARE: {
+        const auto& lhs = operand(instr.a);
+        const auto& rhs = operand(instr.b);
+        const auto op = ExprComparison::op_t(instr.op);
+        const bool result =
+            (lhs.has_number && rhs.has_number) ?
+                ExprComparison::compare(op, lhs.number, rhs.number) :
+                ExprComparison::compare(op, lhs.toAny(), rhs.toAny());
+        if (!result)
+        {
+          registers[instr.dst].setNumber(0.0);
+          pc = instr.target;
+          continue;
+        }
+      }
+      break;
+
+      case OpCode::JUMP_IF_FALSE: {
+        const auto& condition = operand(instr.a);
+        const bool is_true = condition.has_number ? (condition.number != 0.0) :
+                                                    ExprIf::isTrue(condition.any);
+        if (!is_true)
+        {
+          pc = instr.target;
+          continue;
+        }
+      }
+      break;
+
+      case OpCode::JUMP: {
+        pc = instr.target;
+        continue;
+      }
+
+      case OpCode::MOVE: {
+        registers[instr.dst] = operand(instr.a);
+      }
+      break;
+
+      case OpCode::CREATE_ENTRY: {
+        if (!getEntry(instr.a))
+        {
+          const auto op = ExprAssignment::op_t(instr.op);
+          auto entry = ExprAssignment::createEntry(env, program.slots()[instr.a], op);
+          frame.entries[instr.a] = entry.get();
+          frame.new_entries.push_back(std::move(entry));
+        }
+      }
+      break;
+
+      case OpCode::ASSIGN: {
+        auto& dst = registers[instr.dst];
+        dst.has_any = true;
+        dst.has_number = false;
+        const auto op = ExprAssignment::op_t(instr.op);
+        ExprAssignment::assign(env, *frame.entries[instr.a], program.slots()[instr.a],
+                               op, operand(instr.b).toAny(), &dst.any);
+      }
+      break;
+
+      case OpCode::FAIL: {
+        throw RuntimeError(program.messages()[instr.a]);
+      }
+    }
+    pc++;
+  }
+  if (!frame.new_entries.empty())
+  {
+    // some entries were created after the cache: the next execution updates it
+    std::atomic_store(&cache_, std::shared_ptr<const SlotsCache>());
+  }
+  return operand(program.result()).toAny();
+}
+
+}   // namespace BT::Ast
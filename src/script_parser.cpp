@@ -1,5 +1,6 @@
 #include "behaviortree_cpp/scripting/script_parser.hpp"
 #include "behaviortree_cpp/scripting/operators.hpp"
+#include "behaviortree_cpp/scripting/bytecode.hpp"
 
 #include <lexy/action/parse.hpp>
 #include <lexy/action/validate.hpp>
@@ -28,20 +29,7 @@ Expected<ScriptFunction> ParseScript(const std::string& script)
         return nonstd::make_unexpected("Empty Script");
       }
 
-      return [exprs, script](Ast::Environment& env) -> Any {
-        try
-        {
-          for (auto i = 0u; i < exprs.size() - 1; ++i)
-          {
-            exprs[i]->evaluate(env);
-          }
-          return exprs.back()->evaluate(env);
-        }
-        catch (RuntimeError& err)
-        {
-          throw RuntimeError(StrCat("Error in script [",script,"]\n", err.what()));
-        }
-      };
+      return Ast::ProgramExecutor(Ast::Program::compile(exprs, script));
     }
     catch (std::runtime_error& err)
     {
@@ -54,6 +42,45 @@ Expected<ScriptFunction> ParseScript(const std::string& script)
   }
 }
 
+Expected<ScriptFunction> ScriptCache::parse(const std::string& script)
+{
+  {
+    std::shared_lock lk(mutex_);
+    auto it = scripts_.find(script);
+    if (it != scripts_.end())
+    {
+      hits_++;
+      return it->second;
+    }
+  }
+  // parse without locking the mutex. In the unlikely case of
+  // two threads parsing the same script, the first one is stored
+  misses_++;
+  auto executor = ParseScript(script);
+  std::unique_lock lk(mutex_);
+  scripts_.insert({script, executor});
+  return executor;
+}
+
+size_t ScriptCache::size() const
+{
+  std::shared_lock lk(mutex_);
+  return scripts_.size();
+}
+
+void ScriptCache::clear()
+{
+  std::unique_lock lk(mutex_);
+  scripts_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
+Expected<ScriptFunction> ParseScript(const std::string& script, ScriptCache* cache)
+{
+  return cache ? cache->parse(script) : ParseScript(script);
+}
+
 BT::Expected<Any> ParseScriptAndExecute(Ast::Environment& env, const std::string& script)
 {
   auto executor = ParseScript(script);
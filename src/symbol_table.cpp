@@ -0,0 +1,60 @@
+#include "behaviortree_cpp/utils/symbol_table.h"
+#include "behaviortree_cpp/exceptions.h"
+
+#include <mutex>
+
+namespace BT
+{
+
+SymbolTable& SymbolTable::global()
+{
+  static SymbolTable table;
+  return table;
+}
+
+SymbolTable::ID SymbolTable::intern(std::string_view str)
+{
+  if (auto id = find(str); id != InvalidID)
+  {
+    return id;
+  }
+  std::unique_lock lk(mutex_);
+  // added by another thread, in the meantime?
+  if (auto it = ids_.find(str); it != ids_.end())
+  {
+    return it->second;
+  }
+  if (strings_.size() >= InvalidID)
+  {
+    throw RuntimeError("SymbolTable: too many symbols");
+  }
+  const auto id = static_cast<ID>(strings_.size());
+  const auto& stored = strings_.emplace_back(str);
+  ids_.insert({std::string_view(stored), id});
+  return id;
+}
+
+SymbolTable::ID SymbolTable::find(std::string_view str) const
+{
+  std::shared_lock lk(mutex_);
+  auto it = ids_.find(str);
+  return (it == ids_.end()) ? InvalidID : it->second;
+}
+
+std::string_view SymbolTable::str(ID id) const
+{
+  std::shared_lock lk(mutex_);
+  if (id >= strings_.size())
+  {
+    throw RuntimeError("SymbolTable: invalid ID ", std::to_string(id));
+  }
+  return strings_[id];
+}
+
+size_t SymbolTable::size() const
+{
+  std::shared_lock lk(mutex_);
+  return strings_.size();
+}
+
+}   // namespace BT
@@ -0,0 +1,160 @@
+#include "behaviortree_cpp/utils/thread_pool.h"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace BT
+{
+
+ThreadPool::ThreadPool() : ThreadPool(Options())
+{}
+
+ThreadPool::ThreadPool(Options options) : options_(std::move(options))
+{
+  if (options_.max_threads == 0)
+  {
+    options_.max_threads = 1;
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::unique_lock lk(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  // the threads can not move to finished_threads_ once stop_ is set
+  for (auto& thread : threads_)
+  {
+    thread.join();
+  }
+  for (auto& thread : finished_threads_)
+  {
+    thread.join();
+  }
+}
+
+void ThreadPool::execute(Task task)
+{
+  {
+    std::unique_lock lk(mutex_);
+    joinFinishedThreads();
+    tasks_.push_back(std::move(task));
+    // add a thread if no one is waiting for a task
+    if (idle_threads_ < tasks_.size() && threads_.size() < options_.max_threads)
+    {
+      // the new thread can not use the iterator before mutex_ is released
+      auto it = threads_.emplace(threads_.end());
+      *it = std::thread(&ThreadPool::workerLoop, this, it);
+    }
+  }
+  cv_.notify_one();
+}
+
+size_t ThreadPool::threadsCount() const
+{
+  std::unique_lock lk(mutex_);
+  return threads_.size();
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::defaultPool()
+{
+  static std::mutex mutex;
+  static std::weak_ptr<ThreadPool> instance;
+
+  std::unique_lock lk(mutex);
+  auto pool = instance.lock();
+  if (!pool)
+  {
+    pool = std::make_shared<ThreadPool>();
+    instance = pool;
+  }
+  return pool;
+}
+
+void ThreadPool::joinFinishedThreads()
+{
+  // these threads don't need mutex_ anymore: joining them can't deadlock
+  for (auto& thread : finished_threads_)
+  {
+    thread.join();
+  }
+  finished_threads_.clear();
+}
+
+void ThreadPool::workerLoop(ThreadList::iterator self)
+{
+  configureThread();
+
+  auto ready = [this] { return stop_ || !tasks_.empty(); };
+
+  std::unique_lock lk(mutex_);
+  while (true)
+  {
+    idle_threads_++;
+    if (options_.idle_timeout.count() > 0)
+    {
+      if (!cv_.wait_for(lk, options_.idle_timeout, ready))
+      {
+        idle_threads_--;
+        finished_threads_.splice(finished_threads_.end(), threads_, self);
+        return;
+      }
+    }
+    else
+    {
+      cv_.wait(lk, ready);
+    }
+    idle_threads_--;
+
+    // the queue is emptied before stopping
+    if (tasks_.empty())
+    {
+      return;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+
+    lk.unlock();
+    task();
+    // destroy what the task captured, before locking
+    task = nullptr;
+    lk.lock();
+  }
+}
+
+void ThreadPool::configureThread()
+{
+#ifdef __linux__
+  if (!options_.cpu_affinity.empty())
+  {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : options_.cpu_affinity)
+    {
+      CPU_SET(cpu, &cpu_set);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+    {
+      std::cerr << "ThreadPool: failed to set the CPU affinity" << std::endl;
+    }
+  }
+  if (options_.priority > 0)
+  {
+    sched_param param{};
+    param.sched_priority = options_.priority;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+    {
+      std::cerr << "ThreadPool: failed to set the priority " << options_.priority
+                << std::endl;
+    }
+  }
+#endif
+}
+
+}   // namespace BT
@@ -0,0 +1,458 @@
+#include "behaviortree_cpp/tree_executor.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace BT
+{
+
+namespace
+{
+enum EntryState : int
+{
+  WAITING,   // waiting for the next period, or a wake-up signal
+  READY,     // in the queue of a worker
+  RUNNING,   // being ticked
+  DONE
+};
+}   // namespace
+
+struct TreeExecutor::PImpl
+{
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry
+  {
+    TreeID id = 0;
+    std::shared_ptr<Tree> tree;
+    std::chrono::milliseconds period;
+    CompletionCallback on_completed;
+
+    // The transitions WAITING -> READY are done with compare_exchange,
+    // therefore an entry is never in two queues at the same time.
+    std::atomic<int> state = READY;
+    std::atomic_bool woken = false;
+    std::atomic_bool removed = false;
+    // last worker that ticked this tree
+    std::atomic<size_t> worker = 0;
+    // used to discard the outdated timers. Protected by timers_mutex
+    uint64_t generation = 0;
+  };
+  using EntryPtr = std::shared_ptr<Entry>;
+
+  struct Timer
+  {
+    Clock::time_point deadline;
+    EntryPtr entry;
+    uint64_t generation;
+
+    bool operator>(const Timer& other) const
+    {
+      return deadline > other.deadline;
+    }
+  };
+
+  struct Worker
+  {
+    std::mutex mutex;
+    std::deque<EntryPtr> queue;
+    std::thread thread;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic_bool stop = false;
+
+  // The idle workers wait on work_cv, until work_epoch changes
+  // or the first timer expires.
+  std::mutex timers_mutex;
+  std::condition_variable work_cv;
+  std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers;
+  std::atomic<uint64_t> work_epoch = 0;
+
+  mutable std::mutex entries_mutex;
+  std::condition_variable entries_cv;
+  std::unordered_map<TreeID, EntryPtr> entries;
+  TreeID next_id = 1;
+
+  std::atomic<uint64_t> ticks = 0;
+  std::atomic<uint64_t> steals = 0;
+  std::atomic<uint64_t> wakeups = 0;
+
+  void notifyWork()
+  {
+    {
+      std::unique_lock lk(timers_mutex);
+      work_epoch++;
+    }
+    work_cv.notify_one();
+  }
+
+  void push(size_t worker_index, EntryPtr entry)
+  {
+    auto& worker = *workers[worker_index];
+    {
+      std::unique_lock lk(worker.mutex);
+      worker.queue.push_back(std::move(entry));
+    }
+    notifyWork();
+  }
+
+  void schedule(const EntryPtr& entry, Clock::time_point deadline)
+  {
+    bool first_timer = false;
+    {
+      std::unique_lock lk(timers_mutex);
+      first_timer = timers.empty() || deadline < timers.top().deadline;
+      timers.push({deadline, entry, ++entry->generation});
+      if (first_timer)
+      {
+        work_epoch++;
+      }
+    }
+    if (first_timer)
+    {
+      work_cv.notify_one();
+    }
+  }
+
+  void wakeUp(const EntryPtr& entry)
+  {
+    // if the tree is RUNNING, it will be ticked again when the current tick is over
+    entry->woken = true;
+    int expected = WAITING;
+    if (entry->state.compare_exchange_strong(expected, READY))
+    {
+      wakeups++;
+      push(entry->worker, entry);
+    }
+  }
+
+  EntryPtr pop(size_t index)
+  {
+    auto& worker = *workers[index];
+    std::unique_lock lk(worker.mutex);
+    if (worker.queue.empty())
+    {
+      return {};
+    }
+    auto entry = std::move(worker.queue.front());
+    worker.queue.pop_front();
+    return entry;
+  }
+
+  EntryPtr steal(size_t index)
+  {
+    for (size_t i = 1; i < workers.size(); i++)
+    {
+      auto& victim = *workers[(index + i) % workers.size()];
+      std::unique_lock lk(victim.mutex);
+      if (!victim.queue.empty())
+      {
+        auto entry = std::move(victim.queue.back());
+        victim.queue.pop_back();
+        steals++;
+        return entry;
+      }
+    }
+    return {};
+  }
+
+  // Move the trees with an expired timer into the queue of this worker
+  EntryPtr popExpiredTimers(size_t index)
+  {
+    std::vector<EntryPtr> expired;
+    {
+      std::unique_lock lk(timers_mutex);
+      const auto now = Clock::now();
+      while (!timers.empty() && timers.top().deadline <= now)
+      {
+        const auto& timer = timers.top();
+        int expected = WAITING;
+        if (timer.generation == timer.entry->generation &&
+            timer.entry->state.compare_exchange_strong(expected, READY))
+        {
+          expired.push_back(timer.entry);
+        }
+        timers.pop();
+      }
+    }
+    if (expired.empty())
+    {
+      return {};
+    }
+    if (expired.size() > 1)
+    {
+      auto& worker = *workers[index];
+      {
+        std::unique_lock lk(worker.mutex);
+        worker.queue.insert(worker.queue.end(), expired.begin() + 1, expired.end());
+      }
+      // let the idle workers steal them
+      notifyWork();
+    }
+    return expired.front();
+  }
+
+  // To be invoked after changing the state of an entry from RUNNING
+  void notifyIfRemoved(const EntryPtr& entry)
+  {
+    if (entry->removed)
+    {
+      std::unique_lock lk(entries_mutex);
+      entries_cv.notify_all();
+    }
+  }
+
+  void complete(const EntryPtr& entry, NodeStatus status, std::exception_ptr error)
+  {
+    if (error)
+    {
+      entry->tree->haltTree();
+    }
+    entry->tree->wakeUpSignal()->setListener({});
+    if (!entry->removed && entry->on_completed)
+    {
+      entry->on_completed(status, error);
+    }
+    entry->state = DONE;
+    {
+      std::unique_lock lk(entries_mutex);
+      entries.erase(entry->id);
+    }
+    entries_cv.notify_all();
+  }
+
+  void tick(size_t index, const EntryPtr& entry)
+  {
+    int expected = READY;
+    if (!entry->state.compare_exchange_strong(expected, RUNNING))
+    {
+      return;
+    }
+    if (entry->removed)
+    {
+      entry->state = DONE;
+      notifyIfRemoved(entry);
+      return;
+    }
+    entry->worker = index;
+    entry->woken = false;
+
+    const auto start = Clock::now();
+    NodeStatus status = NodeStatus::IDLE;
+    std::exception_ptr error;
+    try
+    {
+      status = entry->tree->tickExactlyOnce();
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+    ticks++;
+
+    if (error || status != NodeStatus::RUNNING)
+    {
+      complete(entry, status, error);
+      return;
+    }
+
+    entry->state = WAITING;
+    notifyIfRemoved(entry);
+
+    if (entry->period.count() > 0)
+    {
+      schedule(entry, start + entry->period);
+    }
+    // woken up during the tick
+    if (entry->woken.exchange(false))
+    {
+      expected = WAITING;
+      if (entry->state.compare_exchange_strong(expected, READY))
+      {
+        wakeups++;
+        push(index, entry);
+      }
+    }
+  }
+
+  void workerLoop(size_t index)
+  {
+    while (!stop)
+    {
+      const uint64_t epoch = work_epoch;
+
+      EntryPtr entry = pop(index);
+      if (!entry)
+      {
+        entry = popExpiredTimers(index);
+      }
+      if (!entry)
+      {
+        entry = steal(index);
+      }
+      if (entry)
+      {
+        tick(index, entry);
+        continue;
+      }
+
+      std::unique_lock lk(timers_mutex);
+      auto has_work = [&] {
+        return stop || work_epoch != epoch ||
+               (!timers.empty() && timers.top().deadline <= Clock::now());
+      };
+      if (timers.empty())
+      {
+        work_cv.wait(lk, has_work);
+      }
+      else
+      {
+        const auto deadline = timers.top().deadline;
+        work_cv.wait_until(lk, deadline, has_work);
+      }
+    }
+  }
+};
+
+TreeExecutor::TreeExecutor(size_t threads) : _p(new PImpl)
+{
+  if (threads == 0)
+  {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < threads; i++)
+  {
+    _p->workers.push_back(std::make_unique<PImpl::Worker>());
+  }
+  for (size_t i = 0; i < threads; i++)
+  {
+    _p->workers[i]->thread = std::thread([this, i]() { _p->workerLoop(i); });
+  }
+}
+
+TreeExecutor::~TreeExecutor()
+{
+  std::vector<PImpl::EntryPtr> remaining;
+  {
+    std::unique_lock lk(_p->entries_mutex);
+    for (auto& [id, entry] : _p->entries)
+    {
+      remaining.push_back(entry);
+    }
+    _p->entries.clear();
+  }
+  // the listeners use this object
+  for (auto& entry : remaining)
+  {
+    entry->removed = true;
+    entry->tree->wakeUpSignal()->setListener({});
+  }
+
+  {
+    std::unique_lock lk(_p->timers_mutex);
+    _p->stop = true;
+  }
+  _p->work_cv.notify_all();
+  for (auto& worker : _p->workers)
+  {
+    worker->thread.join();
+  }
+
+  for (auto& entry : remaining)
+  {
+    entry->tree->haltTree();
+  }
+}
+
+TreeExecutor::TreeID TreeExecutor::add(std::shared_ptr<Tree> tree,
+                                       std::chrono::milliseconds period,
+                                       CompletionCallback on_completed)
+{
+  if (!tree || !tree->wakeUpSignal())
+  {
+    throw RuntimeError("TreeExecutor::add: the tree must be initialized");
+  }
+  auto entry = std::make_shared<PImpl::Entry>();
+  entry->tree = std::move(tree);
+  entry->period = period;
+  entry->on_completed = std::move(on_completed);
+
+  {
+    std::unique_lock lk(_p->entries_mutex);
+    entry->id = _p->next_id++;
+    _p->entries[entry->id] = entry;
+  }
+  entry->worker = entry->id % _p->workers.size();
+
+  std::weak_ptr<PImpl::Entry> weak_entry = entry;
+  entry->tree->wakeUpSignal()->setListener([this, weak_entry]() {
+    if (auto entry = weak_entry.lock())
+    {
+      _p->wakeUp(entry);
+    }
+  });
+
+  const TreeID id = entry->id;
+  const size_t worker = entry->worker;
+  _p->push(worker, std::move(entry));
+  return id;
+}
+
+bool TreeExecutor::remove(TreeID id)
+{
+  PImpl::EntryPtr entry;
+  {
+    std::unique_lock lk(_p->entries_mutex);
+    auto it = _p->entries.find(id);
+    if (it == _p->entries.end())
+    {
+      return false;
+    }
+    entry = it->second;
+    _p->entries.erase(it);
+  }
+  entry->removed = true;
+  entry->tree->wakeUpSignal()->setListener({});
+  {
+    std::unique_lock lk(_p->entries_mutex);
+    _p->entries_cv.wait(lk, [&] { return entry->state != RUNNING; });
+  }
+  entry->tree->haltTree();
+  _p->entries_cv.notify_all();
+  return true;
+}
+
+void TreeExecutor::waitAll()
+{
+  std::unique_lock lk(_p->entries_mutex);
+  _p->entries_cv.wait(lk, [this] { return _p->entries.empty(); });
+}
+
+size_t TreeExecutor::treesCount() const
+{
+  std::unique_lock lk(_p->entries_mutex);
+  return _p->entries.size();
+}
+
+size_t TreeExecutor::threadsCount() const
+{
+  return _p->workers.size();
+}
+
+TreeExecutor::Stats TreeExecutor::stats() const
+{
+  Stats stats;
+  stats.ticks = _p->ticks;
+  stats.steals = _p->steals;
+  stats.wakeups = _p->wakeups;
+  return stats;
+}
+
+}   // namespace BT
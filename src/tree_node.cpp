@@ -14,10 +14,52 @@
 #include "behaviortree_cpp/tree_node.h"
 #include <cstring>
 #include <array>
+#include <atomic>
 
 namespace BT
 {
 
+namespace
+{
+// Prefix of the memory allocated by TreeNode::operator new
+struct alignas(std::max_align_t) AllocationHeader
+{
+  bool from_arena;
+};
+}   // namespace
+
+void* TreeNode::operator new(std::size_t size)
+{
+  const size_t total_size = size + sizeof(AllocationHeader);
+  void* memory = nullptr;
+  bool from_arena = false;
+  if (auto arena = NodeArena::current())
+  {
+    memory = arena->allocate(total_size);
+    from_arena = true;
+  }
+  else
+  {
+    memory = ::operator new(total_size);
+  }
+  auto header = new (memory) AllocationHeader{from_arena};
+  return header + 1;
+}
+
+void TreeNode::operator delete(void* ptr)
+{
+  if (!ptr)
+  {
+    return;
+  }
+  auto header = static_cast<AllocationHeader*>(ptr) - 1;
+  // memory of the arena is released when the arena itself is destroyed
+  if (!header->from_arena)
+  {
+    ::operator delete(header);
+  }
+}
+
 struct TreeNode::PImpl
 {
   PImpl(std::string name, NodeConfig config):
@@ -25,6 +67,16 @@ struct TreeNode::PImpl
     config(std::move(config))
   {}
 
+  // stored next to the TreeNode, when using a NodeArena
+  static void* operator new(std::size_t size)
+  {
+    return TreeNode::operator new(size);
+  }
+  static void operator delete(void* ptr)
+  {
+    TreeNode::operator delete(ptr);
+  }
+
   const std::string name;
 
   NodeStatus status = NodeStatus::IDLE;
@@ -33,28 +85,93 @@ struct TreeNode::PImpl
 
   mutable std::mutex state_mutex;
 
+  // threads blocked in waitValidStatus(). Protected by state_mutex
+  int status_waiters = 0;
+
+  // state_change_signal can be subscribed from any thread. Recursive, because
+  // a callback may subscribe another one
+  std::recursive_mutex observers_mutex;
   StatusChangeSignal state_change_signal;
 
+  // cleared only when state_change_signal is empty. Protected by observers_mutex
+  // when written, read without locking
+  std::atomic_bool has_status_observers = false;
+  // shared by the nodes of a Tree, see Tree::observersAttached()
+  std::shared_ptr<std::atomic<size_t>> observed_nodes;
+
+  // call it with observers_mutex locked
+  void setHasStatusObservers(bool value)
+  {
+    if (has_status_observers.exchange(value) != value && observed_nodes)
+    {
+      if (value)
+      {
+        observed_nodes->fetch_add(1);
+      }
+      else
+      {
+        observed_nodes->fetch_sub(1);
+      }
+    }
+  }
+
   NodeConfig config;
 
   std::string registration_ID;
 
-  PreTickCallback substitution_callback;
+  std::mutex parsed_inputs_mutex;
+  std::unordered_map<std::string, ParsedInput> parsed_inputs;
+
+  // filled by TreeNode::resolvePorts(), read without locking
+  std::vector<LiteralInput> literal_inputs;
+  std::vector<RemappedPort> remapped_ports;
 
-  PostTickCallback post_condition_callback;
+  // published with std::atomic_store, read without locking
+  std::shared_ptr<const PreTickCallback> substitution_callback;
+  std::shared_ptr<const PostTickCallback> post_condition_callback;
+  std::shared_ptr<const TickMonitorCallback> tick_monitor_callback;
+  // true if any of the callbacks is set, to skip the atomic_load
+  std::atomic_bool has_tick_callbacks = false;
 
-  std::mutex callback_injection_mutex;
+  void updateTickCallbacksFlag()
+  {
+    has_tick_callbacks = std::atomic_load(&substitution_callback) ||
+                         std::atomic_load(&post_condition_callback) ||
+                         std::atomic_load(&tick_monitor_callback);
+  }
 
   std::shared_ptr<WakeUpSignal> wake_up;
 
   std::array<ScriptFunction, size_t(PreCond::COUNT_)> pre_parsed;
   std::array<ScriptFunction, size_t(PostCond::COUNT_)> post_parsed;
+
+  // bit N is set if pre_parsed[N] (post_parsed[N]) is not empty
+  uint32_t pre_scripts_mask = 0;
+  uint32_t post_scripts_mask = 0;
+  // the scripts were accessed and the masks must be updated
+  bool scripts_changed = false;
+
+  void updateScriptsMask()
+  {
+    pre_scripts_mask = 0;
+    post_scripts_mask = 0;
+    for (size_t i = 0; i < pre_parsed.size(); i++)
+    {
+      pre_scripts_mask |= pre_parsed[i] ? (1u << i) : 0u;
+    }
+    for (size_t i = 0; i < post_parsed.size(); i++)
+    {
+      post_scripts_mask |= post_parsed[i] ? (1u << i) : 0u;
+    }
+    scripts_changed = false;
+  }
 };
 
 
 TreeNode::TreeNode(std::string name, NodeConfig config) :
   _p(new PImpl(std::move(name), std::move(config)))
 {
+  resolvePorts();
 }
 
 TreeNode::TreeNode(TreeNode &&other) noexcept
@@ -71,6 +188,50 @@ TreeNode &TreeNode::operator=(TreeNode &&other) noexcept
 TreeNode::~TreeNode() {}
 
 NodeStatus TreeNode::executeTick()
+{
+  if (_p->scripts_changed)
+  {
+    _p->updateScriptsMask();
+  }
+  const bool has_callbacks = _p->has_tick_callbacks.load(std::memory_order_acquire);
+
+  // fast path: no scripts and no callbacks
+  if (_p->pre_scripts_mask == 0 && _p->post_scripts_mask == 0 && !has_callbacks)
+  {
+    const NodeStatus new_status = tick();
+    if(new_status != NodeStatus::SKIPPED) {
+      setStatus(new_status);
+    }
+    return new_status;
+  }
+
+  if (has_callbacks)
+  {
+    if (auto monitor = std::atomic_load(&_p->tick_monitor_callback))
+    {
+      const auto t1 = std::chrono::steady_clock::now();
+      auto elapsed = [&t1]() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t1);
+      };
+      NodeStatus new_status = NodeStatus::IDLE;
+      try
+      {
+        new_status = executeTickWithHooks(has_callbacks);
+      }
+      catch (...)
+      {
+        (*monitor)(*this, NodeStatus::IDLE, elapsed());
+        throw;
+      }
+      (*monitor)(*this, new_status, elapsed());
+      return new_status;
+    }
+  }
+  return executeTickWithHooks(has_callbacks);
+}
+
+NodeStatus TreeNode::executeTickWithHooks(bool has_callbacks)
 {
   auto new_status = _p->status;
 
@@ -84,16 +245,12 @@ NodeStatus TreeNode::executeTick()
   {
     // injected pre-callback
     bool substituted = false;
-    if(!isStatusCompleted(_p->status))
+    if(has_callbacks && !isStatusCompleted(_p->status))
     {
-      PreTickCallback  callback;
-      {
-        std::unique_lock lk(_p->callback_injection_mutex);
-        callback = _p->substitution_callback;
-      }
+      auto callback = std::atomic_load(&_p->substitution_callback);
       if(callback)
       {
-        auto override_status = callback(*this);
+        auto override_status = (*callback)(*this);
         if(isStatusCompleted(override_status))
         {
           // don't execute the actual tick()
@@ -113,14 +270,11 @@ NodeStatus TreeNode::executeTick()
   if(isStatusCompleted(new_status))
   {
     checkPostConditions(new_status);
-    PostTickCallback  callback;
-    {
-      std::unique_lock lk(_p->callback_injection_mutex);
-      callback = _p->post_condition_callback;
-    }
+    auto callback = has_callbacks ? std::atomic_load(&_p->post_condition_callback) :
+                                    nullptr;
     if(callback)
     {
-      auto override_status = callback(*this, new_status);
+      auto override_status = (*callback)(*this, new_status);
       if(isStatusCompleted(override_status))
       {
         new_status = override_status;
@@ -139,8 +293,12 @@ void TreeNode::haltNode()
 {
   halt();
 
+  if (_p->scripts_changed)
+  {
+    _p->updateScriptsMask();
+  }
   const auto& parse_executor = _p->post_parsed[size_t(PostCond::ON_HALTED)];
-  if (parse_executor)
+  if (_p->post_scripts_mask != 0 && parse_executor)
   {
     Ast::Environment env = {config().blackboard, config().enums};
     parse_executor(env);
@@ -157,39 +315,184 @@ void TreeNode::setStatus(NodeStatus new_status)
   }
 
   NodeStatus prev_status;
+  bool has_waiters = false;
   {
     std::unique_lock<std::mutex> UniqueLock(_p->state_mutex);
     prev_status = _p->status;
     _p->status = new_status;
+    has_waiters = _p->status_waiters > 0;
   }
   if (prev_status != new_status)
+  {
+    notifyStatusChange(prev_status, new_status, has_waiters);
+  }
+}
+
+void TreeNode::notifyStatusChange(NodeStatus prev_status, NodeStatus new_status,
+                                  bool has_waiters)
+{
+  if (has_waiters)
   {
     _p->state_condition_variable.notify_all();
-    _p->state_change_signal.notify(std::chrono::high_resolution_clock::now(), *this,
-                                   prev_status, new_status);
+  }
+  // skip the clock reading when nobody is listening
+  if (_p->has_status_observers)
+  {
+    const auto now = std::chrono::high_resolution_clock::now();
+    // the lock prevents a subscriber arriving from another thread from
+    // being lost, when the flag is cleared
+    std::scoped_lock lock(_p->observers_mutex);
+    _p->state_change_signal.notify(now, *this, prev_status, new_status);
+    if (_p->state_change_signal.empty())
+    {
+      _p->setHasStatusObservers(false);
+    }
   }
 }
 
 TreeNode::PreScripts &TreeNode::preConditionsScripts() {
+  _p->scripts_changed = true;
   return _p->pre_parsed;
 }
 
 TreeNode::PostScripts &TreeNode::postConditionsScripts() {
+  _p->scripts_changed = true;
   return _p->post_parsed;
 }
 
+TreeNode::ParsedInput& TreeNode::parsedInput(const std::string& key) const
+{
+  return _p->parsed_inputs[key];
+}
+
+std::mutex& TreeNode::parsedInputMutex() const
+{
+  return _p->parsed_inputs_mutex;
+}
+
+void TreeNode::resolvePorts()
+{
+  auto& config = _p->config;
+  _p->literal_inputs.clear();
+  _p->remapped_ports.clear();
+
+  // intern the key of a port remapped to the blackboard. False if it isn't remapped
+  auto add_remapped = [this](const void* port, StringView port_name,
+                             const std::string& source) {
+    StringView remapped_key;
+    if (!getRemappedKey(port_name, source, remapped_key))
+    {
+      return false;
+    }
+    _p->remapped_ports.push_back({port, source, Blackboard::keyID(remapped_key)});
+    return true;
+  };
+
+  for (const auto& [port_name, remapped_port] : config.output_ports)
+  {
+    add_remapped(&remapped_port, port_name, remapped_port);
+  }
+  for (const auto& [port_name, remapped_port] : config.input_ports)
+  {
+    add_remapped(&remapped_port, port_name, remapped_port);
+  }
+  if (!config.manifest)
+  {
+    return;
+  }
+  for (const auto& [port_name, port_info] : config.manifest->ports)
+  {
+    if (port_info.direction() == PortDirection::OUTPUT)
+    {
+      continue;
+    }
+    LiteralInput literal;
+    if (auto it = config.input_ports.find(port_name); it != config.input_ports.end())
+    {
+      // the remapped ones were interned above
+      StringView remapped_key;
+      if (getRemappedKey(port_name, it->second, remapped_key))
+      {
+        continue;
+      }
+      literal.port = &it->second;
+      literal.source = it->second;
+    }
+    else if (port_info.defaultValue().isString())
+    {
+      literal.port = &port_info;
+      literal.source = port_info.defaultValue().cast<std::string>();
+      if (add_remapped(&port_info, port_name, literal.source))
+      {
+        continue;
+      }
+    }
+    else
+    {
+      continue;
+    }
+    // no converter for enums and untyped ports: getInput<T>() will parse them
+    if (!port_info.converter())
+    {
+      continue;
+    }
+    try
+    {
+      literal.value = port_info.parseString(literal.source);
+    }
+    catch (std::exception&)
+    {
+      // the error is reported by getInput(), when the port is read
+      continue;
+    }
+    if (!literal.value.empty())
+    {
+      _p->literal_inputs.push_back(std::move(literal));
+    }
+  }
+}
+
+const TreeNode::LiteralInput* TreeNode::literalInput(const void* port) const
+{
+  for (const auto& literal : _p->literal_inputs)
+  {
+    if (literal.port == port)
+    {
+      return &literal;
+    }
+  }
+  return nullptr;
+}
+
+Blackboard::KeyID TreeNode::remappedKeyID(const void* port, StringView source) const
+{
+  for (const auto& remapped : _p->remapped_ports)
+  {
+    if (remapped.port == port)
+    {
+      // the port might have been modified after the constructor
+      return (remapped.source == source) ? remapped.key : SymbolTable::InvalidID;
+    }
+  }
+  return SymbolTable::InvalidID;
+}
+
 Expected<NodeStatus> TreeNode::checkPreConditions()
 {
+  if (_p->pre_scripts_mask == 0)
+  {
+    return nonstd::make_unexpected("");   // no precondition
+  }
   Ast::Environment env = {config().blackboard, config().enums};
 
   // check the pre-conditions
   for (size_t index = 0; index < size_t(PreCond::COUNT_); index++)
   {
-    const auto& parse_executor = _p->pre_parsed[index];
-    if (!parse_executor)
+    if ((_p->pre_scripts_mask & (1u << index)) == 0)
     {
       continue;
     }
+    const auto& parse_executor = _p->pre_parsed[index];
 
     const PreCond preID = PreCond(index);
 
@@ -234,6 +537,10 @@ Expected<NodeStatus> TreeNode::checkPreConditions()
 
 void TreeNode::checkPostConditions(NodeStatus status)
 {
+  if (_p->post_scripts_mask == 0)
+  {
+    return;
+  }
   auto ExecuteScript = [this](const PostCond& cond) {
     const auto& parse_executor = _p->post_parsed[size_t(cond)];
     if (parse_executor)
@@ -257,17 +564,17 @@ void TreeNode::checkPostConditions(NodeStatus status)
 void TreeNode::resetStatus()
 {
   NodeStatus prev_status;
+  bool has_waiters = false;
   {
     std::unique_lock<std::mutex> lock(_p->state_mutex);
     prev_status = _p->status;
     _p->status = NodeStatus::IDLE;
+    has_waiters = _p->status_waiters > 0;
   }
 
   if (prev_status != NodeStatus::IDLE)
   {
-    _p->state_condition_variable.notify_all();
-    _p->state_change_signal.notify(std::chrono::high_resolution_clock::now(), *this,
-                                   prev_status, NodeStatus::IDLE);
+    notifyStatusChange(prev_status, NodeStatus::IDLE, has_waiters);
   }
 }
 
@@ -281,10 +588,12 @@ NodeStatus TreeNode::waitValidStatus()
 {
   std::unique_lock<std::mutex> lock(_p->state_mutex);
 
+  _p->status_waiters++;
   while (isHalted())
   {
     _p->state_condition_variable.wait(lock);
   }
+  _p->status_waiters--;
   return _p->status;
 }
 
@@ -301,19 +610,48 @@ bool TreeNode::isHalted() const
 TreeNode::StatusChangeSubscriber
 TreeNode::subscribeToStatusChange(TreeNode::StatusChangeCallback callback)
 {
-  return _p->state_change_signal.subscribe(std::move(callback));
+  std::scoped_lock lock(_p->observers_mutex);
+  auto subscriber = _p->state_change_signal.subscribe(std::move(callback));
+  _p->setHasStatusObservers(true);
+  return subscriber;
+}
+
+bool TreeNode::hasStatusObservers() const
+{
+  return _p->has_status_observers;
 }
 
 void TreeNode::setPreTickFunction(PreTickCallback callback)
 {
-  std::unique_lock lk(_p->callback_injection_mutex);
-  _p->substitution_callback = callback;
+  std::shared_ptr<const PreTickCallback> ptr;
+  if (callback)
+  {
+    ptr = std::make_shared<const PreTickCallback>(std::move(callback));
+  }
+  std::atomic_store(&_p->substitution_callback, std::move(ptr));
+  _p->updateTickCallbacksFlag();
 }
 
 void TreeNode::setPostTickFunction(PostTickCallback callback)
 {
-  std::unique_lock lk(_p->callback_injection_mutex);
-  _p->post_condition_callback = callback;
+  std::shared_ptr<const PostTickCallback> ptr;
+  if (callback)
+  {
+    ptr = std::make_shared<const PostTickCallback>(std::move(callback));
+  }
+  std::atomic_store(&_p->post_condition_callback, std::move(ptr));
+  _p->updateTickCallbacksFlag();
+}
+
+void TreeNode::setTickMonitorCallback(TickMonitorCallback callback)
+{
+  std::shared_ptr<const TickMonitorCallback> ptr;
+  if (callback)
+  {
+    ptr = std::make_shared<const TickMonitorCallback>(std::move(callback));
+  }
+  std::atomic_store(&_p->tick_monitor_callback, std::move(ptr));
+  _p->updateTickCallbacksFlag();
 }
 
 uint16_t TreeNode::UID() const
@@ -394,16 +732,23 @@ StringView TreeNode::stripBlackboardPointer(StringView str)
 Expected<StringView> TreeNode::getRemappedKey(StringView port_name,
                                               StringView remapped_port)
 {
-  if (remapped_port == "{=}" || remapped_port == "=")
+  StringView remapped_key;
+  if (getRemappedKey(port_name, remapped_port, remapped_key))
   {
-    return {port_name};
+    return {remapped_key};
   }
-  StringView stripped;
-  if (isBlackboardPointer(remapped_port, &stripped))
+  return nonstd::make_unexpected("Not a blackboard pointer");
+}
+
+bool TreeNode::getRemappedKey(StringView port_name, StringView remapped_port,
+                              StringView& remapped_key)
+{
+  if (remapped_port == "{=}" || remapped_port == "=")
   {
-    return {stripped};
+    remapped_key = port_name;
+    return true;
   }
-  return nonstd::make_unexpected("Not a blackboard pointer");
+  return isBlackboardPointer(remapped_port, &remapped_key);
 }
 
 void TreeNode::emitWakeUpSignal()
@@ -429,6 +774,23 @@ void TreeNode::setWakeUpInstance(std::shared_ptr<WakeUpSignal> instance)
   _p->wake_up = instance;
 }
 
+void TreeNode::setObservedNodesCounter(std::shared_ptr<std::atomic<size_t>> counter)
+{
+  std::scoped_lock lock(_p->observers_mutex);
+  if (_p->has_status_observers)
+  {
+    if (_p->observed_nodes)
+    {
+      _p->observed_nodes->fetch_sub(1);
+    }
+    if (counter)
+    {
+      counter->fetch_add(1);
+    }
+  }
+  _p->observed_nodes = std::move(counter);
+}
+
 void TreeNode::modifyPortsRemapping(const PortsRemapping& new_remapping)
 {
   for (const auto& new_it : new_remapping)
@@ -484,9 +846,10 @@ std::string toStr<PostCond>(const PostCond& pre)
 
 AnyPtrLocked BT::TreeNode::getLockedPortContent(const std::string &key)
 {
-  if(auto remapped_key = getRemappedKey(key, getRawPortValue(key)))
+  StringView remapped_key;
+  if(getRemappedKey(key, getRawPortValue(key), remapped_key))
   {
-    return _p->config.blackboard->getAnyLocked(std::string(*remapped_key));
+    return _p->config.blackboard->getAnyLocked(remapped_key);
   }
   return {};
 }
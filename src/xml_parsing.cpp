@@ -72,6 +72,18 @@ xsdAttributeType(const BT::PortInfo& port_info)
   return std::string();
 }
 
+// Destroys the node first, then releases the NodeArena it was allocated in
+struct ArenaNodeDeleter
+{
+  BT::TreeNode::Ptr node;
+  std::shared_ptr<BT::NodeArena> arena;
+
+  void operator()(BT::TreeNode*)
+  {
+    node.reset();
+  }
+};
+
 } // Anonymous workspace
 
 namespace BT
@@ -89,22 +101,72 @@ struct SubtreeModel
   std::unordered_map<std::string, BT::PortInfo> ports;
 };
 
+struct TreeTemplate::PImpl
+{
+  struct NodeRecord
+  {
+    std::string instance_name;
+    // ID used to instantiate the node with the factory
+    std::string registration_ID;
+    // not empty only in SubTree nodes
+    std::string subtree_ID;
+    // complete, with the exception of the blackboard
+    NodeConfig config;
+    // ports that must be created in the blackboard, if they don't exist
+    std::vector<std::pair<std::string, const PortInfo*>> entries;
+    int subtree = 0;
+    int parent = -1;
+    // index of the subtree created by a SubTree node
+    int child_subtree = -1;
+    // true if at least one record has this one as parent
+    bool has_children = false;
+  };
+
+  struct SubtreeRecord
+  {
+    std::string tree_ID;
+    std::string instance_name;
+    int parent = -1;
+    bool autoremap = false;
+    // either a blackboard pointer or a constant value
+    std::vector<std::pair<std::string, std::string>> remapping;
+  };
+
+  explicit PImpl(const BehaviorTreeFactory& fact) : factory(fact)
+  {}
+
+  const BehaviorTreeFactory& factory;
+  std::string tree_ID;
+  ManifestsSnapshot manifests;
+  // in the same order they are created
+  std::vector<NodeRecord> nodes;
+  std::vector<SubtreeRecord> subtrees;
+
+  Tree instantiate(const Blackboard::Ptr& root_blackboard) const;
+
+  void createSubtree(int index, const Blackboard::Ptr& root_blackboard,
+                     Tree& output_tree) const;
+};
+
 struct XMLParser::PImpl
 {
-  TreeNode::Ptr createNodeFromXML(const XMLElement* element,
-                                  const Blackboard::Ptr& blackboard,
-                                  const TreeNode::Ptr& node_parent,
-                                  const std::string &prefix_path,
-                                  Tree& output_tree);
-
-  void recursivelyCreateSubtree(const std::string& tree_ID,
-                                const std::string &tree_path,
-                                const std::string &prefix_path,
-                                Tree& output_tree,
-                                Blackboard::Ptr blackboard,
-                                const TreeNode::Ptr& root_node,
-                                // [[lcx]]
-                                std::unordered_set<std::string> pretrees);
+  // Return the index of the new node in TreeTemplate::PImpl::nodes
+  int compileNode(const XMLElement* element,
+                  int parent_node,
+                  int subtree,
+                  const std::string &prefix_path,
+                  TreeTemplate::PImpl& output);
+
+  void recursivelyCompileSubtree(const std::string& tree_ID,
+                                 const std::string &tree_path,
+                                 const std::string &prefix_path,
+                                 TreeTemplate::PImpl& output,
+                                 TreeTemplate::PImpl::SubtreeRecord subtree_record,
+                                 int root_node,
+                                 // [[lcx]]
+                                 std::unordered_set<std::string> pretrees);
+
+  std::string mainTreeID(std::string main_tree_ID) const;
 
   void getPortsRecursively(const XMLElement* element,
                            std::vector<std::string>& output_ports);
@@ -550,31 +612,242 @@ void VerifyXML(const std::string& xml_text,
   }
 }
 
-Tree XMLParser::instantiateTree(const Blackboard::Ptr& root_blackboard,
-                                std::string main_tree_ID)
+
+TreeTemplate::TreeTemplate() = default;
+
+TreeTemplate::TreeTemplate(std::shared_ptr<const PImpl> pimpl) : _p(std::move(pimpl))
+{}
+
+Tree TreeTemplate::instantiate(Blackboard::Ptr blackboard) const
 {
+  if (!_p)
+  {
+    throw RuntimeError("TreeTemplate::instantiate: empty template");
+  }
+  auto tree = _p->instantiate(blackboard);
+  tree.manifests = _p->manifests;
+  return tree;
+}
+
+const std::string& TreeTemplate::treeID() const
+{
+  static const std::string empty;
+  return _p ? _p->tree_ID : empty;
+}
+
+size_t TreeTemplate::nodesCount() const
+{
+  return _p ? _p->nodes.size() : 0;
+}
+
+void TreeTemplate::PImpl::createSubtree(int index, const Blackboard::Ptr& root_blackboard,
+                                        Tree& output_tree) const
+{
+  const auto& record = subtrees[index];
+  Blackboard::Ptr blackboard = root_blackboard;
+  if (record.parent >= 0)
+  {
+    blackboard = Blackboard::create(output_tree.subtrees[record.parent]->blackboard);
+    blackboard->enableAutoRemapping(record.autoremap);
+
+    for (const auto& [attr_name, attr_value] : record.remapping)
+    {
+      if (TreeNode::isBlackboardPointer(attr_value))
+      {
+        // do remapping
+        StringView port_name = TreeNode::stripBlackboardPointer(attr_value);
+        blackboard->addSubtreeRemapping(attr_name, port_name);
+      }
+      else
+      {
+        // constant string: just set that constant value into the BB
+        // IMPORTANT: this must not be autoremapped!!!
+        blackboard->enableAutoRemapping(false);
+        blackboard->set(attr_name, attr_value);
+        blackboard->enableAutoRemapping(record.autoremap);
+      }
+    }
+  }
+
+  auto new_tree = std::make_shared<Tree::Subtree>();
+  new_tree->blackboard = blackboard;
+  new_tree->instance_name = record.instance_name;
+  new_tree->tree_ID = record.tree_ID;
+  output_tree.subtrees.push_back(new_tree);
+}
+
+Tree TreeTemplate::PImpl::instantiate(const Blackboard::Ptr& root_blackboard) const
+{
+  if (!root_blackboard)
+  {
+    throw RuntimeError("XMLParser::instantiateTree needs a non-empty "
+                       "root_blackboard");
+  }
   Tree output_tree;
 
+  std::shared_ptr<NodeArena> arena;
+  if (factory.nodeArenaEnabled())
+  {
+    arena = std::make_shared<NodeArena>();
+  }
+  NodeArena::Scope arena_scope(arena.get());
+
+  output_tree.coro_stack_pool =
+      std::make_shared<CoroStackPool>(factory.coroStackPoolOptions());
+
+  createSubtree(0, root_blackboard, output_tree);
+
+  // the nodes that have children, converted once to the class that can accept them
+  struct ParentNode
+  {
+    ControlNode* control = nullptr;
+    DecoratorNode* decorator = nullptr;
+  };
+  std::vector<ParentNode> parent_nodes(nodes.size());
+
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    const auto& record = nodes[i];
+    auto& subtree = output_tree.subtrees[record.subtree];
+    const auto& blackboard = subtree->blackboard;
+
+    // Initialize the ports in the BB to set the type
+    for (const auto& [port_key, port_info] : record.entries)
+    {
+      // if the entry already exists, check that the type is the same
+      if (auto prev_info = blackboard->entryInfo(port_key))
+      {
+        // Check consistency of types.
+        bool const port_type_mismatch = (prev_info->isStronglyTyped() &&
+                                         port_info->isStronglyTyped() &&
+                                         prev_info->type() != port_info->type());
+
+        // special case related to convertFromString
+        bool const string_input = (prev_info->type() == typeid(std::string));
+
+        if(port_type_mismatch && !string_input)
+        {
+          blackboard->debugMessage();
+
+          throw RuntimeError("The creation of the tree failed because the port [",
+                             port_key, "] was initially created with type [",
+                             demangle(prev_info->type()), "] and, later type [",
+                             demangle(port_info->type()), "] was used somewhere else.");
+        }
+      }
+      else
+      {
+        // not found, insert for the first time.
+        blackboard->createEntry(port_key, *port_info);
+      }
+    }
+
+    NodeConfig config = record.config;
+    config.blackboard = blackboard;
+    // same value computed by compileNode(), used in the path
+    config.uid = output_tree.getUID();
+    config.coro_stack_pool = output_tree.coro_stack_pool;
+
+    TreeNode::Ptr new_node =
+        factory.instantiateTreeNode(record.instance_name, record.registration_ID, config);
+
+    if (!record.subtree_ID.empty())
+    {
+      auto subtree_node = dynamic_cast<SubTreeNode*>(new_node.get());
+      if (!subtree_node)
+      {
+        throw RuntimeError("The node [", config.path, "] is not a SubTreeNode");
+      }
+      subtree_node->setSubtreeID(record.subtree_ID);
+    }
+
+    // nodes allocated in a NodeArena must keep it alive
+    if (arena)
+    {
+      auto node_ptr = new_node.get();
+      new_node = TreeNode::Ptr(node_ptr, ArenaNodeDeleter{std::move(new_node), arena});
+    }
+
+    // add the pointer of this node to the parent
+    if (record.parent >= 0)
+    {
+      const auto& parent = parent_nodes[record.parent];
+      if (parent.control)
+      {
+        parent.control->addChild(new_node.get());
+      }
+      else if (parent.decorator)
+      {
+        parent.decorator->setChild(new_node.get());
+      }
+    }
+    if (record.has_children)
+    {
+      auto& parent = parent_nodes[i];
+      parent.control = dynamic_cast<ControlNode*>(new_node.get());
+      if (!parent.control)
+      {
+        parent.decorator = dynamic_cast<DecoratorNode*>(new_node.get());
+      }
+    }
+    subtree->nodes.push_back(std::move(new_node));
+
+    if (record.child_subtree >= 0)
+    {
+      createSubtree(record.child_subtree, root_blackboard, output_tree);
+    }
+  }
+
+  // the subtrees are created depth-first, the parents before their children
+  for (size_t i = 1; i < output_tree.subtrees.size(); i++)
+  {
+    output_tree.subtrees[i]->blackboard->resolveRemappedEntries();
+  }
+
+  output_tree.initialize();
+  return output_tree;
+}
+
+std::string XMLParser::PImpl::mainTreeID(std::string main_tree_ID) const
+{
   // use the main_tree_to_execute argument if it was provided by the user
   // or the one in the FIRST document opened
   if (main_tree_ID.empty())
   {
-    XMLElement* first_xml_root = _p->opened_documents.front()->RootElement();
+    XMLElement* first_xml_root = opened_documents.front()->RootElement();
 
     if (auto main_tree_attribute = first_xml_root->Attribute("main_tree_to_execute"))
     {
       main_tree_ID = main_tree_attribute;
     }
-    else if (_p->tree_roots.size() == 1)
+    else if (tree_roots.size() == 1)
     {
       // special case: there is only one registered BT.
-      main_tree_ID = _p->tree_roots.begin()->first;
+      main_tree_ID = tree_roots.begin()->first;
     }
     else
     {
       throw RuntimeError("[main_tree_to_execute] was not specified correctly");
     }
   }
+  return main_tree_ID;
+}
+
+TreeTemplate XMLParser::createTreeTemplate(std::string main_tree_ID)
+{
+  main_tree_ID = _p->mainTreeID(std::move(main_tree_ID));
+
+  auto output = std::make_shared<TreeTemplate::PImpl>(_p->factory);
+  output->tree_ID = main_tree_ID;
+  output->manifests = _p->factory.manifestsSnapshot();
+  _p->recursivelyCompileSubtree(main_tree_ID, {}, {}, *output, {}, -1, {});
+  return TreeTemplate(std::move(output));
+}
+
+Tree XMLParser::instantiateTree(const Blackboard::Ptr& root_blackboard,
+                                std::string main_tree_ID)
+{
+  main_tree_ID = _p->mainTreeID(std::move(main_tree_ID));
 
   //--------------------------------------
   if (!root_blackboard)
@@ -582,12 +855,7 @@ Tree XMLParser::instantiateTree(const Blackboard::Ptr& root_blackboard,
     throw RuntimeError("XMLParser::instantiateTree needs a non-empty "
                        "root_blackboard");
   }
-
-  _p->recursivelyCreateSubtree(main_tree_ID, {}, {},
-                               output_tree, root_blackboard, TreeNode::Ptr(),
-                               {});
-  output_tree.initialize();
-  return output_tree;
+  return createTreeTemplate(main_tree_ID)._p->instantiate(root_blackboard);
 }
 
 void XMLParser::clearInternalState()
@@ -595,11 +863,9 @@ void XMLParser::clearInternalState()
   _p->clear();
 }
 
-TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
-                                                  const Blackboard::Ptr& blackboard,
-                                                  const TreeNode::Ptr& node_parent,
-                                                  const std::string& prefix_path,
-                                                  Tree& output_tree)
+int XMLParser::PImpl::compileNode(const XMLElement* element, int parent_node,
+                                  int subtree, const std::string& prefix_path,
+                                  TreeTemplate::PImpl& output)
 {
   const auto element_name = element->Name();
   const auto element_ID = element->Attribute("ID");
@@ -688,10 +954,21 @@ TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
     }
   }
 
-  NodeConfig config;
-  config.blackboard = blackboard;
+  TreeTemplate::PImpl::NodeRecord record;
+  record.instance_name = instance_name;
+  record.subtree = subtree;
+  record.parent = parent_node;
+  if (parent_node >= 0)
+  {
+    output.nodes[parent_node].has_children = true;
+  }
+
+  NodeConfig& config = record.config;
+  config.script_cache = factory.scriptCache();
+  config.executor = factory.executor();
   config.path = prefix_path + instance_name;
-  config.uid = output_tree.getUID();
+  // same UID assigned by Tree::getUID() to the N-th node
+  config.uid = uint16_t(output.nodes.size() + 1);
   config.manifest = manifest;
 
   if(type_ID == instance_name)
@@ -718,16 +995,11 @@ TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
   }
 
   //---------------------------------------------
-  TreeNode::Ptr new_node;
-
   if (node_type == NodeType::SUBTREE)
   {
     config.input_ports = port_remap;
-    new_node = factory.instantiateTreeNode(instance_name,
-                                           toStr(NodeType::SUBTREE),
-                                           config);
-    auto subtree_node = dynamic_cast<SubTreeNode*>(new_node.get());
-    subtree_node->setSubtreeID(type_ID);
+    record.registration_ID = toStr(NodeType::SUBTREE);
+    record.subtree_ID = type_ID;
   }
   else
   {
@@ -736,6 +1008,7 @@ TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
       auto msg = StrCat("Missing manifest for element_ID: ", element_ID, ". It shouldn't happen. Please report this issue.");
       throw RuntimeError(msg);
     }
+    record.registration_ID = type_ID;
 
     //Check that name in remapping can be found in the manifest
     for (const auto& [name_in_subtree, _] : port_remap)
@@ -749,7 +1022,7 @@ TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
       }
     }
 
-    // Initialize the ports in the BB to set the type
+    // The ports will be created in the BB, to set the type
     for (const auto& [port_name, port_info] : manifest->ports)
     {
       auto remap_it = port_remap.find(port_name);
@@ -763,33 +1036,7 @@ TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
       {
         // port_key will contain the key to find the entry in the blackboard
         const auto port_key = static_cast<std::string>(param_res.value());
-
-        // if the entry already exists, check that the type is the same
-        if (auto prev_info = blackboard->entryInfo(port_key))
-        {
-          // Check consistency of types.
-          bool const port_type_mismatch = (prev_info->isStronglyTyped() &&
-                                           port_info.isStronglyTyped() &&
-                                           prev_info->type() != port_info.type());
-
-          // special case related to convertFromString
-          bool const string_input = (prev_info->type() == typeid(std::string));
-
-          if(port_type_mismatch && !string_input)
-          {
-            blackboard->debugMessage();
-
-            throw RuntimeError("The creation of the tree failed because the port [",
-                               port_key, "] was initially created with type [",
-                               demangle(prev_info->type()), "] and, later type [",
-                               demangle(port_info.type()), "] was used somewhere else.");
-          }
-        }
-        else
-        {
-          // not found, insert for the first time.
-          blackboard->createEntry(port_key, port_info);
-        }
+        record.entries.push_back({port_key, &port_info});
       }
     }
 
@@ -836,49 +1083,33 @@ TreeNode::Ptr XMLParser::PImpl::createNodeFromXML(const XMLElement* element,
         }
       }
     }
-
-    new_node = factory.instantiateTreeNode(instance_name, type_ID, config);
   }
 
-  // add the pointer of this node to the parent
-  if (node_parent != nullptr)
-  {
-    if (auto control_parent = dynamic_cast<ControlNode*>(node_parent.get()))
-    {
-      control_parent->addChild(new_node.get());
-    }
-    else if (auto decorator_parent = dynamic_cast<DecoratorNode*>(node_parent.get()))
-    {
-      decorator_parent->setChild(new_node.get());
-    }
-  }
-
-  return new_node;
+  output.nodes.push_back(std::move(record));
+  return int(output.nodes.size() - 1);
 }
 
-void BT::XMLParser::PImpl::recursivelyCreateSubtree(
+void BT::XMLParser::PImpl::recursivelyCompileSubtree(
     const std::string& tree_ID,
     const std::string& tree_path,
     const std::string& prefix_path,
-    Tree& output_tree,
-    Blackboard::Ptr blackboard,
-    const TreeNode::Ptr& root_node,
+    TreeTemplate::PImpl& output,
+    TreeTemplate::PImpl::SubtreeRecord subtree_record,
+    int root_node,
     std::unordered_set<std::string> pretrees)
 {
-  std::function<void(const TreeNode::Ptr&, Tree::Subtree::Ptr, std::string, const XMLElement*)>
-      recursiveStep;
+  std::function<void(int, int, std::string, const XMLElement*)> recursiveStep;
 
-  recursiveStep = [&, this](TreeNode::Ptr parent_node,
-                      Tree::Subtree::Ptr subtree,
+  recursiveStep = [&, this](int parent_node,
+                      int subtree,
                       std::string prefix,
                       const XMLElement* element)
   {
     // create the node
-    auto node = createNodeFromXML(element, blackboard, parent_node, prefix, output_tree);
-    subtree->nodes.push_back(node);
+    const int node = compileNode(element, parent_node, subtree, prefix, output);
 
     // common case: iterate through all children
-    if (node->type() != NodeType::SUBTREE)
+    if (output.nodes[node].subtree_ID.empty())
     {
       for (auto child_element = element->FirstChildElement(); child_element;
            child_element = child_element->NextSiblingElement())
@@ -888,7 +1119,8 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(
     }
     else   // special case: SubTreeNode
     {
-      auto new_bb = Blackboard::create(blackboard);
+      TreeTemplate::PImpl::SubtreeRecord new_subtree;
+      new_subtree.parent = subtree;
       const std::string subtree_ID = element->Attribute("ID");
 
       // [[lcx]]
@@ -911,7 +1143,7 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(
         if (StrEqual(attr_name, "_autoremap"))
         {
           do_autoremap = convertFromString<bool>(attr_value);
-          new_bb->enableAutoRemapping(do_autoremap);
+          new_subtree.autoremap = do_autoremap;
           continue;
         }
         if (!IsAllowedPortName(attr->Name()))
@@ -950,26 +1182,9 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(
           }
         }
       }
+      new_subtree.remapping.assign(remapping.begin(), remapping.end());
 
-      for(const auto& [attr_name, attr_value]: remapping)
-      {
-        if (TreeNode::isBlackboardPointer(attr_value))
-        {
-          // do remapping
-          StringView port_name = TreeNode::stripBlackboardPointer(attr_value);
-          new_bb->addSubtreeRemapping(attr_name, port_name);
-        }
-        else
-        {
-          // constant string: just set that constant value into the BB
-          // IMPORTANT: this must not be autoremapped!!!
-          new_bb->enableAutoRemapping(false);
-          new_bb->set(attr_name, static_cast<std::string>(attr_value));
-          new_bb->enableAutoRemapping(do_autoremap);
-        }
-      }
-
-      std::string subtree_path = subtree->instance_name;
+      std::string subtree_path = output.subtrees[subtree].instance_name;
       if(!subtree_path.empty()) {
         subtree_path += "/";
       }
@@ -977,14 +1192,14 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(
         subtree_path +=  name;
       }
       else {
-        subtree_path += subtree_ID + "::" + std::to_string(node->UID());
+        subtree_path += subtree_ID + "::" + std::to_string(output.nodes[node].config.uid);
       }
 
-      recursivelyCreateSubtree(subtree_ID,
-                               subtree_path, // name
-                               subtree_path + "/",  //prefix
-                               output_tree, new_bb, node,
-                               new_pretrees);
+      recursivelyCompileSubtree(subtree_ID,
+                                subtree_path, // name
+                                subtree_path + "/",  //prefix
+                                output, std::move(new_subtree), node,
+                                new_pretrees);
     }
   };
 
@@ -999,13 +1214,16 @@ void BT::XMLParser::PImpl::recursivelyCreateSubtree(
   //-------- start recursion -----------
 
   // Append a new subtree to the list
-  auto new_tree = std::make_shared<Tree::Subtree>();
-  new_tree->blackboard = blackboard;
-  new_tree->instance_name = tree_path;
-  new_tree->tree_ID = tree_ID;
-  output_tree.subtrees.push_back(new_tree);
+  subtree_record.instance_name = tree_path;
+  subtree_record.tree_ID = tree_ID;
+  output.subtrees.push_back(std::move(subtree_record));
+  const int subtree_index = int(output.subtrees.size() - 1);
+  if (root_node >= 0)
+  {
+    output.nodes[root_node].child_subtree = subtree_index;
+  }
 
-  recursiveStep(root_node, new_tree, prefix_path, root_element);
+  recursiveStep(root_node, subtree_index, prefix_path, root_element);
 }
 
 void XMLParser::PImpl::getPortsRecursively(const XMLElement* element,
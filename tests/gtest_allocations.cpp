@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "behaviortree_cpp/bt_factory.h"
+
+using namespace BT;
+
+// The global operator new is replaced in the entire test executable,
+// but the allocations are counted only when count_allocations is true,
+// in the thread that set it.
+namespace
+{
+thread_local bool count_allocations = false;
+std::atomic<size_t> allocations_count = 0;
+}   // namespace
+
+void* operator new(std::size_t size)
+{
+  if (count_allocations)
+  {
+    allocations_count++;
+  }
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+static const char* xml_text = R"(
+<root BTCPP_format="4" main_tree_to_execute="MainTree">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code="counter := 0; flag := true; ratio := 0.5" />
+      <Fallback>
+        <Inverter>
+          <SubTree ID="Increment" value="{counter}" />
+        </Inverter>
+        <AlwaysSuccess/>
+      </Fallback>
+      <ReactiveSequence>
+        <ScriptCondition code="flag == true" />
+        <Repeat num_cycles="3">
+          <SubTree ID="Increment" value="{counter}" />
+        </Repeat>
+      </ReactiveSequence>
+      <ReactiveFallback>
+        <ScriptCondition code="counter > 100" />
+        <RetryUntilSuccessful num_attempts="2">
+          <ForceSuccess>
+            <AlwaysFailure/>
+          </ForceSuccess>
+        </RetryUntilSuccessful>
+      </ReactiveFallback>
+      <Parallel success_count="2" failure_count="1">
+        <AlwaysSuccess/>
+        <SubTree ID="Increment" value="{counter}" _skipIf="ratio > 1.0" />
+      </Parallel>
+      <IfThenElse>
+        <ScriptCondition code="counter >= 5" />
+        <SetBlackboard output_key="result" value="done" />
+        <AlwaysFailure/>
+      </IfThenElse>
+      <Switch2 variable="{counter}" case_1="1" case_2="2">
+        <AlwaysFailure/>
+        <AlwaysFailure/>
+        <AlwaysSuccess/>
+      </Switch2>
+      <SequenceWithMemory>
+        <WhileDoElse>
+          <ScriptCondition code="ratio &lt; 1.0" />
+          <Script code="ratio = ratio * 1.0" />
+          <AlwaysFailure/>
+        </WhileDoElse>
+        <Precondition if="flag" else="FAILURE">
+          <AlwaysSuccess/>
+        </Precondition>
+        <RunOnce then_skip="true">
+          <AlwaysSuccess/>
+        </RunOnce>
+        <Sleep msec="0"/>
+        <ParallelAll max_failures="1">
+          <AlwaysSuccess/>
+          <AlwaysSuccess/>
+        </ParallelAll>
+        <Script code="message := 'short string'" />
+        <SetBlackboard output_key="copy" value="{message}" />
+      </SequenceWithMemory>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Increment">
+    <Sequence>
+      <Script code="value += 1" _skipIf="value > 1000" />
+      <AlwaysSuccess _while="value > 0"/>
+    </Sequence>
+  </BehaviorTree>
+</root>)";
+
+// Once warmed up, ticking the built-in nodes should not allocate any memory.
+// Known exceptions: strings longer than 15 characters, blackboard keys longer
+// than the small string optimization of std::string, and the nodes that
+// start a timer (Timeout, Delay).
+TEST(Allocations, SteadyStateTick)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml_text);
+
+  // warm up
+  for (int i = 0; i < 3; i++)
+  {
+    ASSERT_EQ(tree.tickOnce(), NodeStatus::SUCCESS);
+  }
+
+  allocations_count = 0;
+  count_allocations = true;
+  NodeStatus status = NodeStatus::IDLE;
+  for (int i = 0; i < 10; i++)
+  {
+    status = tree.tickOnce();
+  }
+  count_allocations = false;
+
+  ASSERT_EQ(status, NodeStatus::SUCCESS);
+  ASSERT_EQ(allocations_count, 0);
+}
+
+namespace
+{
+struct PlanarPose
+{
+  double x, y, theta;
+};
+}   // namespace
+
+TEST(Allocations, BlackboardSmallStructs)
+{
+  static_assert(Any::isStoredInline<PlanarPose>(), "PlanarPose should fit BT::Any");
+
+  auto bb = Blackboard::create();
+  bb->set("pose", PlanarPose{1, 2, 3});
+  bb->set("count", 0);
+  auto entry = bb->getEntry("pose");
+
+  allocations_count = 0;
+  count_allocations = true;
+  for (int i = 0; i < 10; i++)
+  {
+    bb->set("pose", PlanarPose{double(i), 2, 3});
+    bb->setEntry("pose", *entry, PlanarPose{double(i), 2, 3});
+    bb->set("count", bb->get<int>("count") + 1);
+  }
+  const auto pose = bb->get<PlanarPose>("pose");
+  count_allocations = false;
+
+  ASSERT_EQ(pose.x, 9);
+  ASSERT_EQ(bb->get<int>("count"), 10);
+  ASSERT_EQ(allocations_count, 0);
+}
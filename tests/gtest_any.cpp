@@ -13,6 +13,7 @@
 #include <charconv>  // std::{from_chars,from_chars_result},
 #include <string>
 #include <system_error>  // std::errc.
+#include <tuple>  // std::ignore
 
 #include <gtest/gtest.h>
 
@@ -248,3 +249,43 @@ TEST(Any, Cast)
     EXPECT_EQ(a.cast<std::vector<int>>(), v);
   }
 }
+
+TEST(Any, InlineStorage)
+{
+  struct Pose3D
+  {
+    double x, y, z;
+    double qx, qy, qz, qw;
+  };
+  struct Point3D
+  {
+    double x, y, z;
+  };
+
+  EXPECT_TRUE(Any::isStoredInline<double>());
+  EXPECT_TRUE(Any::isStoredInline<SafeAny::SimpleString>());
+  EXPECT_TRUE(Any::isStoredInline<std::shared_ptr<int>>());
+  EXPECT_EQ(Any::isStoredInline<Point3D>(), sizeof(Point3D) <= ANY_IMPL_STACK_SIZE);
+  EXPECT_EQ(Any::isStoredInline<Pose3D>(), sizeof(Pose3D) <= ANY_IMPL_STACK_SIZE);
+
+  Any a(Point3D{1, 2, 3});
+  Any b(a);
+  Any c(std::move(b));
+  EXPECT_EQ(c.cast<Point3D>().z, 3);
+  EXPECT_ANY_THROW(std::ignore = c.cast<double>());
+  a = Any(Pose3D{1, 2, 3, 0, 0, 0, 1});
+  EXPECT_EQ(a.cast<Pose3D>().qw, 1);
+
+  // conversions between numbers and strings
+  Any number(42);
+  Any copy(std::string("0"));
+  EXPECT_ANY_THROW(Any(std::string("7")).copyInto(number));
+  EXPECT_TRUE(number.isIntegral());
+  Any(3.0).copyInto(number);
+  EXPECT_EQ(number.cast<int64_t>(), 3);
+  Any unsigned_number(uint64_t(1));
+  Any(int64_t(5)).copyInto(unsigned_number);
+  EXPECT_EQ(unsigned_number.cast<uint64_t>(), 5);
+  EXPECT_EQ(Any(int64_t(5)).cast<std::string>(), "5");
+  EXPECT_EQ(copy.cast<int>(), 0);
+}
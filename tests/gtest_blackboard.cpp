@@ -514,3 +514,92 @@ TEST(BlackboardTest, NullOutputRemapping)
 
 
 
+
+struct SmallPose
+{
+  double x = 0;
+  double y = 0;
+};
+
+TEST(BlackboardTest, LockFreeRead)
+{
+  auto bb = Blackboard::create();
+
+  bb->set("value", 42.0);
+  bb->enableLockFreeRead<double>("value");
+  bb->enableLockFreeRead<SmallPose>("pose");
+
+  auto value_entry = bb->getEntry("value");
+  auto pose_entry = bb->getEntry("pose");
+
+  double value = 0;
+  ASSERT_TRUE(Blackboard::getLockFree(*value_entry, value));
+  ASSERT_EQ(value, 42.0);
+
+  // wrong type or never written
+  int wrong_type = 0;
+  ASSERT_FALSE(Blackboard::getLockFree(*value_entry, wrong_type));
+  SmallPose pose;
+  ASSERT_FALSE(Blackboard::getLockFree(*pose_entry, pose));
+  ASSERT_ANY_THROW(bb->enableLockFreeRead<int>("value"));
+
+  // writes from scripts are visible too
+  auto executor = ParseScript("value += 1.5");
+  ASSERT_TRUE(executor);
+  Ast::Environment env = {bb, {}};
+  executor.value()(env);
+  ASSERT_TRUE(Blackboard::getLockFree(*value_entry, value));
+  ASSERT_EQ(value, 43.5);
+
+  // the reader should never see a partially written pose
+  std::atomic_bool done = false;
+  std::thread writer([&]() {
+    for(int i = 1; i <= 10000; i++)
+    {
+      bb->set("pose", SmallPose{double(i), -double(i)});
+    }
+    done = true;
+  });
+
+  while(!done)
+  {
+    if(Blackboard::getLockFree(*pose_entry, pose))
+    {
+      ASSERT_EQ(pose.x, -pose.y);
+    }
+  }
+  writer.join();
+  ASSERT_TRUE(Blackboard::getLockFree(*pose_entry, pose));
+  ASSERT_EQ(pose.x, 10000.0);
+}
+
+TEST(BlackboardTest, InternedKeys)
+{
+  auto& symbols = SymbolTable::global();
+  const auto id = Blackboard::keyID("interned_key");
+  ASSERT_EQ(id, symbols.intern(std::string("interned_key")));
+  ASSERT_EQ(symbols.str(id), "interned_key");
+  ASSERT_EQ(symbols.find("never_used_interned_key"), SymbolTable::InvalidID);
+
+  auto parent = Blackboard::create();
+  auto bb = Blackboard::create(parent);
+  bb->addSubtreeRemapping("interned_key", "parent_key");
+  bb->set("local_a", 1);
+  bb->set(id, 42);
+  bb->set("local_b", 2);
+
+  ASSERT_EQ(parent->get<int>("parent_key"), 42);
+  ASSERT_EQ(bb->getEntry(id), parent->getEntry(StringView("parent_key")));
+  ASSERT_EQ(bb->get<int>(StringView("interned_key")), 42);
+  ASSERT_FALSE(bb->getEntry("never_used_interned_key"));
+  ASSERT_EQ(symbols.find("never_used_interned_key"), SymbolTable::InvalidID);
+
+  bb->unset("local_a");
+  ASSERT_FALSE(bb->getEntry("local_a"));
+  ASSERT_EQ(bb->get<int>("local_b"), 2);
+  ASSERT_EQ(bb->getKeys().size(), 2);
+
+  bb->clear();
+  ASSERT_TRUE(bb->getKeys().empty());
+  ASSERT_EQ(parent->get<int>("parent_key"), 42);
+}
@@ -1,5 +1,6 @@
 #include "behaviortree_cpp/decorators/timeout_node.h"
 #include "behaviortree_cpp/behavior_tree.h"
+#include "behaviortree_cpp/bt_factory.h"
 #include <chrono>
 #include <future>
 #include <gtest/gtest.h>
@@ -166,3 +167,146 @@ TEST(CoroTest, OtherThreadHalt)
   handle.wait();
   std::cout << "----- 4 ------ " << std::endl;
 }
+
+class YieldingCoroAction : public BT::CoroActionNode
+{
+public:
+  YieldingCoroAction(const std::string& name, const BT::NodeConfig& config) :
+    BT::CoroActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return {};
+  }
+
+protected:
+  BT::NodeStatus tick() override
+  {
+    // use some stack, to be measured
+    volatile char buffer[4096];
+    for (size_t i = 0; i < sizeof(buffer); i++)
+    {
+      buffer[i] = char(i);
+    }
+    setStatusRunningAndYield();
+    setStatusRunningAndYield();
+    return BT::NodeStatus::SUCCESS;
+  }
+};
+
+TEST(CoroTest, StackPool)
+{
+  static const char* xml_text = R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <Repeat num_cycles="10">
+                <YieldingCoroAction/>
+            </Repeat>
+        </BehaviorTree>
+    </root>)";
+
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<YieldingCoroAction>("YieldingCoroAction");
+
+  BT::CoroStackPool::Options options;
+  options.stack_sizes["YieldingCoroAction"] = 128 * 1024;
+  options.measure_stack_usage = true;
+  factory.setCoroStackPoolOptions(options);
+
+  auto tree = factory.createTreeFromText(xml_text);
+  ASSERT_TRUE(tree.coro_stack_pool);
+  ASSERT_EQ(tree.tickWhileRunning(milliseconds(0)), BT::NodeStatus::SUCCESS);
+
+  // the same block is used by all the cycles
+  const auto stats = tree.coro_stack_pool->stats();
+  ASSERT_EQ(stats.allocated_blocks, 1);
+  ASSERT_EQ(stats.reused_blocks, 9);
+  ASSERT_EQ(stats.cached_blocks, 1);
+  ASSERT_GE(stats.cached_bytes, 128 * 1024);
+
+  const size_t high_water = stats.stack_high_water.at("YieldingCoroAction");
+  ASSERT_GE(high_water, 4096);
+  ASSERT_LT(high_water, 128 * 1024);
+}
+
+class WaitingAwaitableAction : public BT::AwaitableActionNode
+{
+public:
+  WaitingAwaitableAction(const std::string& name, const BT::NodeConfig& config) :
+    BT::AwaitableActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return {BT::InputPort<int>("value")};
+  }
+
+  int resumes = 0;
+
+protected:
+  Task run() override
+  {
+    resumes++;
+    co_await sleepFor(milliseconds(20));
+    resumes++;
+    co_await notification();
+    resumes++;
+    co_await entryUpdated("value");
+    resumes++;
+    co_return (getInput<int>("value").value() == 42) ? BT::NodeStatus::SUCCESS :
+                                                       BT::NodeStatus::FAILURE;
+  }
+};
+
+TEST(CoroTest, AwaitableAction)
+{
+  static const char* xml_text = R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <WaitingAwaitableAction value="{value}"/>
+        </BehaviorTree>
+    </root>)";
+
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<WaitingAwaitableAction>("WaitingAwaitableAction");
+
+  auto blackboard = BT::Blackboard::create();
+  blackboard->set("value", 0);
+  auto tree = factory.createTreeFromText(xml_text, blackboard);
+  auto action = dynamic_cast<WaitingAwaitableAction*>(tree.rootNode());
+  ASSERT_TRUE(action);
+
+  ASSERT_EQ(tree.tickOnce(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(action->resumes, 1);
+  // the timer didn't expire: the coroutine is not resumed
+  ASSERT_EQ(tree.tickOnce(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(action->resumes, 1);
+
+  // the timer wakes up the tree
+  auto t1 = std::chrono::steady_clock::now();
+  tree.sleep(milliseconds(1000));
+  ASSERT_LT(std::chrono::steady_clock::now() - t1, milliseconds(500));
+  ASSERT_EQ(tree.tickOnce(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(action->resumes, 2);
+
+  ASSERT_EQ(tree.tickOnce(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(action->resumes, 2);
+  std::async(std::launch::async, [action]() { action->notify(); }).wait();
+  ASSERT_EQ(tree.tickOnce(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(action->resumes, 3);
+
+  ASSERT_EQ(tree.tickOnce(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(action->resumes, 3);
+  blackboard->set("value", 42);
+  ASSERT_EQ(tree.tickOnce(), BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(action->resumes, 4);
+
+  // halt destroys the coroutine: the next tick starts from the beginning
+  ASSERT_EQ(tree.tickOnce(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(action->resumes, 5);
+  tree.haltTree();
+  ASSERT_EQ(action->status(), BT::NodeStatus::IDLE);
+  ASSERT_EQ(tree.tickOnce(), BT::NodeStatus::RUNNING);
+  ASSERT_EQ(action->resumes, 6);
+}
@@ -11,6 +11,7 @@
 */
 
 #include <gtest/gtest.h>
+#include <thread>
 #include "action_test_node.h"
 #include "behaviortree_cpp/bt_factory.h"
 #include "test_helper.hpp"
@@ -220,3 +221,92 @@ TEST(Decorator, RunOnce)
 }
 
 
+
+TEST(Decorator, SharedTimerQueue)
+{
+  BT::BehaviorTreeFactory factory;
+
+  std::string xml_text = R"(
+    <root BTCPP_format="4" >
+       <BehaviorTree>
+          <Parallel success_count="-1">)";
+  for(int i=0; i<50; i++)
+  {
+    xml_text += R"(
+            <Timeout msec="1000"> <Sleep msec="20"/> </Timeout>
+            <Delay delay_msec="10"> <AlwaysSuccess/> </Delay>)";
+  }
+  xml_text += R"(
+          </Parallel>
+       </BehaviorTree>
+    </root>)";
+
+  {
+    auto tree = factory.createTreeFromText(xml_text);
+    // 150 timed nodes, one worker
+    ASSERT_EQ(BT::SharedTimerQueue<>::useCount(), 150);
+    ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  }
+  ASSERT_EQ(BT::SharedTimerQueue<>::useCount(), 0);
+
+  // destroying the tree while timers are still pending must be safe
+  for(int i=0; i<5; i++)
+  {
+    auto tree = factory.createTreeFromText(xml_text);
+    ASSERT_EQ(tree.tickOnce(), NodeStatus::RUNNING);
+  }
+  ASSERT_EQ(BT::SharedTimerQueue<>::useCount(), 0);
+}
+
+namespace
+{
+// The halt() waits for the tick() to return
+class SlowThreadedAction : public BT::ThreadedAction
+{
+public:
+  SlowThreadedAction(const std::string& name, const BT::NodeConfig& config,
+                     std::thread::id* halt_thread) :
+    BT::ThreadedAction(name, config), halt_thread_(halt_thread)
+  {}
+
+  NodeStatus tick() override
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return NodeStatus::SUCCESS;
+  }
+
+  void halt() override
+  {
+    *halt_thread_ = std::this_thread::get_id();
+    BT::ThreadedAction::halt();
+  }
+
+  static BT::PortsList providedPorts()
+  {
+    return {};
+  }
+
+private:
+  std::thread::id* halt_thread_;
+};
+}   // namespace
+
+TEST(Decorator, TimeoutHaltsInTickThread)
+{
+  BT::BehaviorTreeFactory factory;
+  std::thread::id halt_thread;
+  factory.registerNodeType<SlowThreadedAction>("SlowThreadedAction", &halt_thread);
+
+  auto tree = factory.createTreeFromText(R"(
+    <root BTCPP_format="4" >
+       <BehaviorTree>
+          <Timeout msec="5">
+             <SlowThreadedAction/>
+          </Timeout>
+       </BehaviorTree>
+    </root>)");
+
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::FAILURE);
+  // not halted by the timer thread shared by all the nodes
+  ASSERT_EQ(halt_thread, std::this_thread::get_id());
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
+#include <atomic>
 #include <filesystem>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include "behaviortree_cpp/xml_parsing.h"
@@ -449,3 +451,274 @@ TEST(BehaviorTreeFactory, addMetadataToManifest)
   const auto& modified_manifest = factory.manifests().at("SaySomething");
   EXPECT_EQ(modified_manifest.metadata, makeTestMetadata());
 }
+
+TEST(BehaviorTreeFactory, NodeArena)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4" main_tree_to_execute="MainTree">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code=" counter:=0 "/>
+      <Repeat num_cycles="3">
+        <Script code=" counter+=1 "/>
+      </Repeat>
+      <SubTree ID="Inner" _autoremap="true"/>
+    </Sequence>
+  </BehaviorTree>
+  <BehaviorTree ID="Inner">
+    <Script code=" counter+=10 "/>
+  </BehaviorTree>
+</root>)";
+
+  BehaviorTreeFactory factory;
+  EXPECT_FALSE(factory.nodeArenaEnabled());
+  factory.enableNodeArena(true);
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  std::weak_ptr<TreeNode> weak_root;
+  {
+    auto tree = factory.createTree("MainTree");
+
+    // nodes are allocated contiguously, in depth-first order
+    std::vector<const TreeNode*> nodes;
+    applyRecursiveVisitor(static_cast<const TreeNode*>(tree.rootNode()),
+                          [&](const TreeNode* n) { nodes.push_back(n); });
+    ASSERT_EQ(nodes.size(), 6);
+    for(size_t i = 1; i < nodes.size(); i++)
+    {
+      EXPECT_LT(nodes[i - 1], nodes[i]);
+    }
+
+    ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+    ASSERT_EQ(tree.rootBlackboard()->get<int>("counter"), 13);
+    weak_root = tree.subtrees.front()->nodes.front();
+  }
+  ASSERT_TRUE(weak_root.expired());
+
+  // nodes can outlive the tree
+  TreeNode::Ptr node;
+  {
+    auto tree = factory.createTree("Inner");
+    node = tree.subtrees.front()->nodes.front();
+  }
+  ASSERT_EQ(node->registrationName(), "Script");
+  node.reset();
+}
+
+TEST(BehaviorTreeFactory, StatusObservers)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(R"(
+<root BTCPP_format="4">
+  <BehaviorTree>
+    <Sequence>
+      <AlwaysSuccess/>
+      <AlwaysSuccess/>
+    </Sequence>
+  </BehaviorTree>
+</root>)");
+
+  auto root = tree.rootNode();
+  ASSERT_FALSE(root->hasStatusObservers());
+  ASSERT_FALSE(tree.observersAttached());
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+
+  int transitions = 0;
+  auto subscriber = root->subscribeToStatusChange(
+      [&](TimePoint, const TreeNode&, NodeStatus, NodeStatus) { transitions++; });
+  ASSERT_TRUE(root->hasStatusObservers());
+  ASSERT_TRUE(tree.observersAttached());
+
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  // IDLE -> RUNNING -> SUCCESS -> IDLE
+  ASSERT_EQ(transitions, 3);
+
+  // expired subscribers are removed at the next status change
+  subscriber.reset();
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_FALSE(root->hasStatusObservers());
+  ASSERT_FALSE(tree.observersAttached());
+  ASSERT_EQ(transitions, 3);
+}
+
+TEST(BehaviorTreeFactory, StatusObserversFromAnotherThread)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(R"(
+<root BTCPP_format="4">
+  <BehaviorTree>
+    <Sequence>
+      <AlwaysSuccess/>
+    </Sequence>
+  </BehaviorTree>
+</root>)");
+
+  auto root = tree.rootNode();
+  std::atomic_bool done = false;
+  std::thread ticker([&]() {
+    while (!done)
+    {
+      tree.tickExactlyOnce();
+    }
+  });
+
+  // a subscriber attached while the tree runs must receive the events,
+  // even if the previous one expired at the same time
+  for (int i = 0; i < 100; i++)
+  {
+    std::atomic_int transitions = 0;
+    auto subscriber = root->subscribeToStatusChange(
+        [&](TimePoint, const TreeNode&, NodeStatus, NodeStatus) { transitions++; });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (transitions == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::yield();
+    }
+    subscriber.reset();
+    ASSERT_GT(transitions, 0) << "iteration " << i;
+  }
+  done = true;
+  ticker.join();
+}
+
+TEST(BehaviorTreeFactory, TreeTemplate)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code="counter:=0" />
+      <SubTree ID="Increment" value="{counter}" />
+      <SubTree ID="Increment" value="{counter}" />
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Increment">
+    <Script code="value+=1" />
+  </BehaviorTree>
+</root>)";
+
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  auto tree_template = factory.createTreeTemplate("MainTree");
+  ASSERT_EQ(tree_template.treeID(), "MainTree");
+  ASSERT_EQ(tree_template.nodesCount(), 6);
+
+  auto reference = factory.createTree("MainTree");
+  auto tree_A = tree_template.instantiate();
+  auto tree_B = tree_template.instantiate();
+
+  // same structure of the tree created by the factory
+  auto GetNodes = [](const Tree& tree) {
+    std::vector<std::pair<std::string, uint16_t>> nodes;
+    for (const auto& subtree : tree.subtrees)
+    {
+      for (const auto& node : subtree->nodes)
+      {
+        nodes.push_back({ node->fullPath(), node->UID() });
+      }
+    }
+    return nodes;
+  };
+  const auto expected = GetNodes(reference);
+  const auto nodes_A = GetNodes(tree_A);
+  ASSERT_EQ(expected, nodes_A);
+  ASSERT_EQ(tree_A.subtrees.size(), 3);
+  ASSERT_EQ(tree_A.manifests.size(), reference.manifests.size());
+
+  // the instances are independent
+  ASSERT_EQ(tree_A.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(tree_A.rootBlackboard()->get<int>("counter"), 2);
+  ASSERT_FALSE(tree_B.rootBlackboard()->getEntry("counter"));
+
+  auto blackboard = Blackboard::create();
+  auto tree_C = tree_template.instantiate(blackboard);
+  ASSERT_EQ(tree_C.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(blackboard->get<int>("counter"), 2);
+
+  ASSERT_ANY_THROW(auto unused = factory.createTreeTemplate("Undefined"));
+}
+
+TEST(BehaviorTreeFactory, FreezeAndCreateConcurrently)
+{
+  static const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <Script code="counter:=0" />
+      <SubTree ID="Increment" value="{counter}" />
+      <SubTree ID="Increment" value="{counter}" />
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Increment">
+    <Script code="value+=1" _skipIf="value > 100" />
+  </BehaviorTree>
+</root>)";
+
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+  ASSERT_FALSE(factory.frozen());
+  factory.freeze();
+  ASSERT_TRUE(factory.frozen());
+
+  ASSERT_THROW(factory.registerBehaviorTreeFromText(xml_text), LogicError);
+  ASSERT_THROW(factory.registerNodeType<DummyNodes::SaySomething>("Say"), LogicError);
+  ASSERT_THROW(factory.registerScriptingEnum("ONE", 1), LogicError);
+  ASSERT_THROW(factory.addSubstitutionRule("*", "AlwaysSuccess"), LogicError);
+
+  const int threads_count = 4;
+  const int trees_per_thread = 50;
+  std::atomic_int success_count = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; t++)
+  {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < trees_per_thread; i++)
+      {
+        auto tree = factory.createTree("MainTree");
+        if (tree.tickWhileRunning() == NodeStatus::SUCCESS &&
+            tree.rootBlackboard()->get<int>("counter") == 2)
+        {
+          success_count++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  ASSERT_EQ(success_count, threads_count * trees_per_thread);
+}
+
+TEST(BehaviorTreeFactory, SharedManifests)
+{
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <AlwaysSuccess/>
+    </Sequence>
+  </BehaviorTree>
+</root>)");
+
+  auto tree_A = factory.createTree("MainTree");
+  auto tree_B = factory.createTree("MainTree");
+  ASSERT_EQ(tree_A.manifests.size(), factory.manifests().size());
+  ASSERT_EQ(tree_A.manifests.shared(), tree_B.manifests.shared());
+  ASSERT_EQ(tree_A.manifests.at("Sequence").type, NodeType::CONTROL);
+
+  // compatible with the std::unordered_map used before
+  const std::unordered_map<std::string, TreeNodeManifest>& manifests_map = tree_A.manifests;
+  ASSERT_EQ(&manifests_map, &tree_B.manifests.map());
+
+  // a new copy is created only when the factory changes
+  factory.registerNodeType<DummyNodes::SaySomething>("SaySomething");
+  auto tree_C = factory.createTree("MainTree");
+  ASSERT_NE(tree_A.manifests.shared(), tree_C.manifests.shared());
+  ASSERT_EQ(tree_A.manifests.count("SaySomething"), 0);
+  ASSERT_EQ(tree_C.manifests.count("SaySomething"), 1);
+}
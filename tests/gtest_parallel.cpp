@@ -12,6 +12,10 @@
 */
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
 #include "action_test_node.h"
 #include "behaviortree_cpp/loggers/bt_observer.h"
 #include "condition_test_node.h"
@@ -596,3 +600,96 @@ TEST(Parallel, PauseWithRetry)
 }
 
 
+
+TEST(Parallel, ConcurrentParallel)
+{
+  using namespace BT;
+
+  BehaviorTreeFactory factory;
+
+  std::mutex mutex;
+  std::map<std::string, std::thread::id> threads;
+
+  auto slow_action = [&](TreeNode& node) {
+    std::this_thread::sleep_for(milliseconds(100));
+    std::unique_lock lk(mutex);
+    threads[node.name()] = std::this_thread::get_id();
+    return (node.name() == "bad") ? NodeStatus::FAILURE : NodeStatus::SUCCESS;
+  };
+  factory.registerSimpleAction("SlowAction", slow_action);
+
+  const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <ConcurrentParallel max_failures="{max_failures}" tick_thread_children="3">
+      <SlowAction name="first"/>
+      <SlowAction name="bad"/>
+      <SlowAction name="third"/>
+      <SlowAction name="fourth"/>
+    </ConcurrentParallel>
+  </BehaviorTree>
+</root>  )";
+
+  auto tree = factory.createTreeFromText(xml_text);
+  tree.rootBlackboard()->set("max_failures", 1);
+
+  auto t1 = std::chrono::steady_clock::now();
+  ASSERT_EQ(NodeStatus::FAILURE, tree.tickOnce());
+  // the children have been executed concurrently
+  ASSERT_LT(std::chrono::steady_clock::now() - t1, milliseconds(350));
+
+  ASSERT_EQ(threads.size(), 4);
+  const auto this_thread = std::this_thread::get_id();
+  ASSERT_EQ(threads["first"], this_thread);
+  ASSERT_NE(threads["bad"], this_thread);
+  ASSERT_NE(threads["third"], this_thread);
+  ASSERT_EQ(threads["fourth"], this_thread);
+
+  tree.rootBlackboard()->set("max_failures", 2);
+  ASSERT_EQ(NodeStatus::SUCCESS, tree.tickOnce());
+}
+
+TEST(Parallel, NestedConcurrentParallel)
+{
+  using namespace BT;
+
+  // a single worker, always busy with the outer children
+  BT::ThreadPool::Options options;
+  options.max_threads = 1;
+  auto executor = std::make_shared<BT::ThreadPool>(options);
+
+  BehaviorTreeFactory factory;
+  factory.setExecutor(executor);
+  std::atomic_int ticks = 0;
+  factory.registerSimpleAction("SlowAction", [&](TreeNode&) {
+    std::this_thread::sleep_for(milliseconds(10));
+    ticks++;
+    return NodeStatus::SUCCESS;
+  });
+
+  const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <ConcurrentParallel>
+      <ConcurrentParallel>
+        <SlowAction/>
+        <SlowAction/>
+        <SlowAction/>
+      </ConcurrentParallel>
+      <ConcurrentParallel>
+        <SlowAction/>
+        <SlowAction/>
+      </ConcurrentParallel>
+      <SlowAction/>
+    </ConcurrentParallel>
+  </BehaviorTree>
+</root>  )";
+
+  auto tree = factory.createTreeFromText(xml_text);
+  for (int i = 0; i < 5; i++)
+  {
+    ASSERT_EQ(NodeStatus::SUCCESS, tree.tickOnce());
+  }
+  ASSERT_EQ(ticks, 30);
+  ASSERT_LE(executor->threadsCount(), 1);
+}
@@ -595,3 +595,189 @@ TEST(PortTest, DefaultWronglyOverriden)
   // This is correct
   ASSERT_NO_THROW( auto tree = factory.createTreeFromText(xml_txt_correct));
 }
+
+class NodeWithPortHandles : public SyncActionNode
+{
+public:
+  NodeWithPortHandles(const std::string& name, const NodeConfig& config) :
+    SyncActionNode(name, config),
+    in_(*this, "in"),
+    offset_(*this, "offset"),
+    out_(*this, "out")
+  {}
+
+  NodeStatus tick() override
+  {
+    int in = 0;
+    int offset = 0;
+    if(!in_.get(in) || !offset_.get(offset) || !out_.set(in + offset))
+    {
+      return NodeStatus::FAILURE;
+    }
+    return NodeStatus::SUCCESS;
+  }
+
+  static PortsList providedPorts()
+  {
+    return {BT::InputPort<int>("in"),
+            BT::InputPort<int>("offset", 1, "added to [in]"),
+            BT::OutputPort<int>("out")};
+  }
+
+private:
+  InputPortHandle<int> in_;
+  InputPortHandle<int> offset_;
+  OutputPortHandle<int> out_;
+};
+
+TEST(PortTest, PortHandles)
+{
+  std::string xml_txt = R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <Sequence>
+                <Script code="value:=10" />
+                <NodeWithPortHandles in="{value}" out="{value}" />
+                <NodeWithPortHandles in="{value}" out="{value}" offset="5" />
+                <SubTree ID="Inner" external="{value}" />
+            </Sequence>
+        </BehaviorTree>
+
+        <BehaviorTree ID="Inner">
+            <NodeWithPortHandles in="{external}" out="{external}" offset="100"/>
+        </BehaviorTree>
+    </root>)";
+
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<NodeWithPortHandles>("NodeWithPortHandles");
+  factory.registerBehaviorTreeFromText(xml_txt);
+  auto tree = factory.createTree("MainTree");
+
+  for(int i = 0; i < 3; i++)
+  {
+    ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  }
+  // every tick: +1, +5, +100 (the Script resets the value to 10)
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("value"), 116);
+
+  // missing mandatory port
+  std::string xml_missing = R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <NodeWithPortHandles out="{value}" />
+        </BehaviorTree>
+    </root>)";
+  auto tree_missing = factory.createTreeFromText(xml_missing);
+  ASSERT_EQ(tree_missing.tickWhileRunning(), NodeStatus::FAILURE);
+}
+
+struct CountedParse
+{
+  int value = 0;
+  static int parse_count;
+};
+int CountedParse::parse_count = 0;
+
+template <> [[nodiscard]]
+CountedParse BT::convertFromString<CountedParse>(StringView str)
+{
+  CountedParse::parse_count++;
+  return {convertFromString<int>(str)};
+}
+
+class NodeReadingCountedParse : public SyncActionNode
+{
+public:
+  NodeReadingCountedParse(const std::string& name, const NodeConfig& config) :
+    SyncActionNode(name, config)
+  {}
+
+  NodeStatus tick() override
+  {
+    auto literal = getInput<CountedParse>("literal");
+    auto entry = getInput<CountedParse>("entry");
+    if(!literal || !entry)
+    {
+      return NodeStatus::FAILURE;
+    }
+    setOutput("sum", literal->value + entry->value);
+    return NodeStatus::SUCCESS;
+  }
+
+  static PortsList providedPorts()
+  {
+    return {BT::InputPort<CountedParse>("literal"),
+            BT::InputPort<CountedParse>("entry"),
+            BT::OutputPort<int>("sum")};
+  }
+};
+
+TEST(PortTest, ParsedInputsCache)
+{
+  std::string xml_txt = R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <NodeReadingCountedParse literal="5" entry="{text}" sum="{sum}"/>
+        </BehaviorTree>
+    </root>)";
+
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<NodeReadingCountedParse>("NodeReadingCountedParse");
+  // an entry of type std::string, to be converted by getInput()
+  auto blackboard = Blackboard::create();
+  blackboard->set("text", std::string("7"));
+  auto tree = factory.createTreeFromText(xml_txt, blackboard);
+
+  // the literal port was already parsed, when the node was created
+  CountedParse::parse_count = 0;
+  for(int i = 0; i < 3; i++)
+  {
+    ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+    ASSERT_EQ(blackboard->get<int>("sum"), 12);
+  }
+  // the entry is parsed only once
+  ASSERT_EQ(CountedParse::parse_count, 1);
+
+  // parse again when the entry changes
+  blackboard->set("text", std::string("9"));
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(blackboard->get<int>("sum"), 14);
+  ASSERT_EQ(CountedParse::parse_count, 2);
+}
+
+TEST(PortTest, RemappedKeysInterned)
+{
+  // the SymbolTable is shared by the whole process and never releases a key:
+  // use names that no other test (or repetition of this one) interned before
+  static int run = 0;
+  const std::string entry_key = "interned_entry_" + std::to_string(run);
+  const std::string sum_key = "interned_sum_" + std::to_string(run);
+  run++;
+
+  std::string xml_txt = StrCat(R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <NodeReadingCountedParse literal="5" entry="{)", entry_key, R"(}"
+                                     sum="{)", sum_key, R"(}"/>
+        </BehaviorTree>
+    </root>)");
+
+  auto& symbols = SymbolTable::global();
+  ASSERT_EQ(symbols.find(entry_key), SymbolTable::InvalidID);
+  ASSERT_EQ(symbols.find(sum_key), SymbolTable::InvalidID);
+
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<NodeReadingCountedParse>("NodeReadingCountedParse");
+  auto tree = factory.createTreeFromText(xml_txt);
+
+  // the keys of the remapped ports are interned when the node is created
+  ASSERT_NE(symbols.find(entry_key), SymbolTable::InvalidID);
+  ASSERT_NE(symbols.find(sum_key), SymbolTable::InvalidID);
+
+  // the entry is still empty
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::FAILURE);
+
+  tree.rootBlackboard()->set(entry_key, std::string("3"));
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>(sum_key), 8);
+}
@@ -298,3 +298,51 @@ TEST(Preconditions, Issue615_NoSkipWhenRunning_B)
   tree.rootBlackboard()->set("check", false);
   ASSERT_EQ( tree.tickOnce(), NodeStatus::RUNNING );
 }
+
+TEST(Preconditions, TickCallbacks)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <Sequence>
+                <AlwaysSuccess name="first"/>
+                <AlwaysSuccess name="second" _post="counter+=1"/>
+            </Sequence>
+        </BehaviorTree>
+    </root>)");
+  tree.rootBlackboard()->set("counter", 0);
+
+  TreeNode* first = nullptr;
+  tree.applyVisitor([&](TreeNode* node) {
+    if(node->name() == "first") {
+      first = node;
+    }
+  });
+  ASSERT_NE(first, nullptr);
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("counter"), 1);
+
+  int pre_count = 0;
+  int post_count = 0;
+  first->setPreTickFunction([&](TreeNode&) {
+    pre_count++;
+    return NodeStatus::FAILURE;
+  });
+  first->setPostTickFunction([&](TreeNode&, NodeStatus status) {
+    post_count++;
+    return status;
+  });
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::FAILURE);
+  ASSERT_EQ(pre_count, 1);
+  ASSERT_EQ(post_count, 1);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("counter"), 1);
+
+  // remove the callbacks
+  first->setPreTickFunction({});
+  first->setPostTickFunction({});
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(pre_count, 1);
+  ASSERT_EQ(post_count, 1);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("counter"), 2);
+}
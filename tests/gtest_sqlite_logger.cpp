@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <thread>
+#include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/loggers/bt_sqlite_logger.h"
+#include "cpp-sqlite/sqlite.hpp"
+
+using namespace BT;
+
+namespace
+{
+const char* xml_text = R"(
+<root BTCPP_format="4">
+  <BehaviorTree>
+    <Sequence>
+      <AlwaysSuccess/>
+      <AlwaysSuccess/>
+    </Sequence>
+  </BehaviorTree>
+</root>)";
+
+std::filesystem::path TempDatabase(const std::string& name)
+{
+  auto path = std::filesystem::temp_directory_path() / (name + ".db3");
+  std::filesystem::remove(path);
+  return path;
+}
+
+int64_t CountTransitions(const std::filesystem::path& path, int64_t min_timestamp = 0)
+{
+  sqlite::Connection db(path.string());
+  auto res = sqlite::Query(db, "SELECT COUNT(*) FROM Transitions WHERE timestamp >= ?;",
+                           min_timestamp);
+  int64_t count = 0;
+  while (res.Next())
+  {
+    count = res.Get(0);
+  }
+  return count;
+}
+
+bool HasTransition(const std::filesystem::path& path, int64_t timestamp)
+{
+  sqlite::Connection db(path.string());
+  auto res =
+      sqlite::Query(db, "SELECT COUNT(*) FROM Transitions WHERE timestamp = ?;", timestamp);
+  int64_t count = 0;
+  while (res.Next())
+  {
+    count = res.Get(0);
+  }
+  return count == 1;
+}
+
+// Invoke the callback directly, much faster than the writer thread
+void LogTransitions(SqliteLogger& logger, const TreeNode& node, int count, int64_t first_usec)
+{
+  for (int i = 0; i < count; i++)
+  {
+    const auto timestamp = std::chrono::microseconds(first_usec + i);
+    logger.callback(timestamp, node, NodeStatus::IDLE, NodeStatus::RUNNING);
+  }
+}
+}   // namespace
+
+TEST(SqliteLogger, FlushOnDestruction)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml_text);
+  const auto path = TempDatabase("sqlite_logger_flush");
+  {
+    SqliteLogger logger(tree, path);
+    ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+    LogTransitions(logger, *tree.rootNode(), 1000, 1'000'000);
+    ASSERT_EQ(logger.droppedTransitions(), 0);
+  }
+  // Sequence and children: IDLE->RUNNING->SUCCESS->IDLE, AlwaysSuccess: ->SUCCESS->IDLE
+  ASSERT_EQ(CountTransitions(path), 3 + 2 * 2 + 1000);
+  std::filesystem::remove(path);
+}
+
+TEST(SqliteLogger, OverflowBlock)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml_text);
+  const auto path = TempDatabase("sqlite_logger_block");
+  {
+    SqliteLogger::Options options;
+    options.max_queue_size = 1;
+    options.overflow_policy = SqliteLogger::OverflowPolicy::BLOCK;
+    SqliteLogger logger(tree, path, options);
+    LogTransitions(logger, *tree.rootNode(), 1000, 1'000'000);
+    ASSERT_EQ(logger.droppedTransitions(), 0);
+  }
+  ASSERT_EQ(CountTransitions(path), 1000);
+  std::filesystem::remove(path);
+}
+
+TEST(SqliteLogger, OverflowDropNewest)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml_text);
+  const auto path = TempDatabase("sqlite_logger_drop_newest");
+  size_t dropped = 0;
+  {
+    SqliteLogger::Options options;
+    options.max_queue_size = 1;
+    options.overflow_policy = SqliteLogger::OverflowPolicy::DROP_NEWEST;
+    SqliteLogger logger(tree, path, options);
+    LogTransitions(logger, *tree.rootNode(), 1000, 1'000'000);
+    dropped = logger.droppedTransitions();
+  }
+  ASSERT_EQ(CountTransitions(path) + int64_t(dropped), 1000);
+  // the queue was empty when the first one was added
+  ASSERT_TRUE(HasTransition(path, 1'000'000));
+  std::filesystem::remove(path);
+}
+
+TEST(SqliteLogger, OverflowDropOldest)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml_text);
+  const auto path = TempDatabase("sqlite_logger_drop_oldest");
+  size_t dropped = 0;
+  {
+    SqliteLogger::Options options;
+    options.max_queue_size = 1;
+    options.overflow_policy = SqliteLogger::OverflowPolicy::DROP_OLDEST;
+    SqliteLogger logger(tree, path, options);
+    LogTransitions(logger, *tree.rootNode(), 1000, 1'000'000);
+    dropped = logger.droppedTransitions();
+  }
+  ASSERT_EQ(CountTransitions(path) + int64_t(dropped), 1000);
+  // the newest transition is never discarded
+  ASSERT_TRUE(HasTransition(path, 1'000'000 + 999));
+  std::filesystem::remove(path);
+}
+
+TEST(SqliteLogger, RollbackFailedBatch)
+{
+  BehaviorTreeFactory factory;
+  auto tree = factory.createTreeFromText(xml_text);
+  const auto path = TempDatabase("sqlite_logger_rollback");
+  {
+    SqliteLogger logger(tree, path);
+    {
+      // a duplicated primary key makes the batch fail
+      sqlite::Connection db(path.string());
+      sqlite::Statement(db, "INSERT INTO Transitions VALUES (1000005, 0, 0, 0, 0);");
+    }
+    LogTransitions(logger, *tree.rootNode(), 10, 1'000'000);
+    // wait for the writer thread to fail
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (logger.droppedTransitions() == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_GE(logger.droppedTransitions(), 1);
+
+    // the transaction was rolled back: the following batches are written
+    LogTransitions(logger, *tree.rootNode(), 10, 2'000'000);
+  }
+  ASSERT_EQ(CountTransitions(path, 2'000'000), 10);
+  std::filesystem::remove(path);
+}
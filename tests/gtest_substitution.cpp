@@ -1,4 +1,5 @@
 ﻿#include <gtest/gtest.h>
+#include <set>
 #include "behaviortree_cpp/bt_factory.h"
 
 using namespace BT;
@@ -49,3 +50,71 @@ TEST(Substitution, Parser)
 
   ASSERT_EQ(*std::get_if<std::string>(&rules.at("actionC")), "NotAConfig");
 }
+
+TEST(Substitution, WildcardRules)
+{
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <Sequence>
+      <AlwaysFailure name="exact"/>
+      <SubTree ID="Sub" name="sub_A"/>
+      <SubTree ID="Sub" name="sub_B"/>
+      <AlwaysFailure name="untouched"/>
+    </Sequence>
+  </BehaviorTree>
+
+  <BehaviorTree ID="Sub">
+    <Sequence>
+      <AlwaysFailure name="first"/>
+      <AlwaysFailure name="second"/>
+    </Sequence>
+  </BehaviorTree>
+</root>)");
+
+  // many rules that don't match anything
+  for (int i = 0; i < 200; i++)
+  {
+    factory.addSubstitutionRule(StrCat("sub_C/node_", std::to_string(i), "*"),
+                                "AlwaysFailure");
+    factory.addSubstitutionRule(StrCat("*/action_", std::to_string(i)), "AlwaysFailure");
+  }
+  factory.addSubstitutionRule("exact", "AlwaysSuccess");
+  factory.addSubstitutionRule("sub_A/*", "AlwaysSuccess");
+  factory.addSubstitutionRule("*/second", "AlwaysSuccess");
+  factory.addSubstitutionRule("sub_?/f*st", "AlwaysSuccess");
+
+  // paths of the nodes replaced by AlwaysSuccess
+  auto Substituted = [](const Tree& tree) {
+    std::set<std::string> paths;
+    for (const auto& subtree : tree.subtrees)
+    {
+      for (const auto& node : subtree->nodes)
+      {
+        if (dynamic_cast<const AlwaysSuccessNode*>(node.get()))
+        {
+          paths.insert(node->fullPath());
+        }
+      }
+    }
+    return paths;
+  };
+
+  auto tree = factory.createTree("MainTree");
+  const auto substituted = Substituted(tree);
+  // the sixth one is the root of the subtree sub_A
+  ASSERT_EQ(substituted.size(), 6);
+  ASSERT_EQ(substituted.count("exact"), 1);
+  ASSERT_EQ(substituted.count("sub_A/first"), 1);
+  ASSERT_EQ(substituted.count("sub_A/second"), 1);
+  ASSERT_EQ(substituted.count("sub_B/first"), 1);
+  ASSERT_EQ(substituted.count("sub_B/second"), 1);
+
+  // the rules are compiled again when they change
+  factory.clearSubstitutionRules();
+  factory.addSubstitutionRule("*/second", "AlwaysSuccess");
+  auto new_tree = factory.createTree("MainTree");
+  const std::set<std::string> expected = { "sub_A/second", "sub_B/second" };
+  ASSERT_EQ(Substituted(new_tree), expected);
+}
@@ -696,3 +696,88 @@ TEST(SubTree, PrivateAutoRemapping)
   ASSERT_EQ(console[0], "hello");
 }
 
+
+TEST(SubTree, RemappingResolvedAtCreation)
+{
+    // clang-format off
+
+  static const char* xml_text = R"(
+  <root BTCPP_format="4">
+    <BehaviorTree ID="Level2">
+      <Script code="result := local_speed + 1" />
+    </BehaviorTree>
+
+    <BehaviorTree ID="Level1">
+      <SubTree ID="Level2" local_speed="{speed}" _autoremap="true"/>
+    </BehaviorTree>
+
+    <BehaviorTree ID="MainTree">
+      <SubTree ID="Level1" speed="{root_speed}" result="{result}"/>
+    </BehaviorTree>
+  </root>
+ )";
+
+  // clang-format on
+  BehaviorTreeFactory factory;
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  auto root_bb = Blackboard::create();
+  root_bb->set("root_speed", 41);
+  auto tree = factory.createTree("MainTree", root_bb);
+  ASSERT_EQ(tree.subtrees.size(), 3);
+
+  // the links to the entries of the ancestors are not reported as local entries
+  auto level2_bb = tree.subtrees[2]->blackboard;
+  const auto& const_level2_bb = *level2_bb;
+  ASSERT_EQ(const_level2_bb.getEntry("local_speed"), root_bb->getEntry("root_speed"));
+  ASSERT_FALSE(level2_bb->entryInfo("local_speed"));
+  ASSERT_TRUE(level2_bb->getKeys().empty());
+
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  ASSERT_EQ(root_bb->get<int>("result"), 42);
+}
+
+TEST(SubTree, AutoRemappingCopiesOnlyUsedKeys)
+{
+    // clang-format off
+
+  static const char* xml_text = R"(
+  <root BTCPP_format="4">
+    <BehaviorTree ID="Child">
+      <SaySomething message="{greeting}" />
+    </BehaviorTree>
+
+    <BehaviorTree ID="MainTree">
+      <Sequence>
+        <SubTree ID="Child" _autoremap="true"/>
+        <SubTree ID="Child" _autoremap="true"/>
+      </Sequence>
+    </BehaviorTree>
+  </root>
+ )";
+
+  // clang-format on
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<DummyNodes::SaySomething>("SaySomething");
+  factory.registerBehaviorTreeFromText(xml_text);
+
+  auto root_bb = Blackboard::create();
+  root_bb->set("greeting", std::string("hello"));
+  for (int i = 0; i < 100; i++)
+  {
+    root_bb->set("unused_" + std::to_string(i), i);
+  }
+  auto tree = factory.createTree("MainTree", root_bb);
+  ASSERT_EQ(tree.subtrees.size(), 3);
+
+  for (size_t i = 1; i < tree.subtrees.size(); i++)
+  {
+    auto bb = tree.subtrees[i]->blackboard;
+    ASSERT_EQ(bb->getEntry("greeting"), root_bb->getEntry("greeting"));
+    // the entries not used by the subtree were not copied
+    ASSERT_EQ(bb->getKeys().size(), 1);
+    // but they are still visible through the autoremapping
+    ASSERT_EQ(bb->get<int>("unused_42"), 42);
+  }
+  ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+}
@@ -14,9 +14,17 @@
 #include "action_test_node.h"
 #include "condition_test_node.h"
 #include "behaviortree_cpp/behavior_tree.h"
+#include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/loggers/bt_tick_profiler.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 using BT::NodeStatus;
 using std::chrono::milliseconds;
@@ -117,8 +125,286 @@ TEST_F(BehaviorTreeTest, PrintWithStream)
   ASSERT_TRUE(std::getline(stream, line, '\n').fail());
 }
 
+// Count the tasks and forward them to a ThreadPool.
+struct CountingExecutor : public BT::Executor
+{
+  BT::ThreadPool pool{ BT::ThreadPool::Options{ 1, {}, 0 } };
+  std::atomic_int count = 0;
+
+  void execute(Task task) override
+  {
+    count++;
+    pool.execute(std::move(task));
+  }
+};
+
+class ShortThreadedAction : public BT::ThreadedAction
+{
+public:
+  ShortThreadedAction(const std::string& name, const BT::NodeConfig& config) :
+    BT::ThreadedAction(name, config)
+  {}
+
+  NodeStatus tick() override
+  {
+    std::this_thread::sleep_for(milliseconds(1));
+    return NodeStatus::SUCCESS;
+  }
+
+  static BT::PortsList providedPorts()
+  {
+    return {};
+  }
+};
+
+TEST(ThreadedActionExecutor, FactoryExecutor)
+{
+  auto executor = std::make_shared<CountingExecutor>();
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<ShortThreadedAction>("ShortThreadedAction");
+  factory.setExecutor(executor);
+
+  auto tree = factory.createTreeFromText(R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <Sequence>
+                <ShortThreadedAction/>
+                <ShortThreadedAction/>
+            </Sequence>
+        </BehaviorTree>
+    </root>)");
+
+  for(int i = 0; i < 3; i++)
+  {
+    ASSERT_EQ(tree.tickWhileRunning(milliseconds(1)), NodeStatus::SUCCESS);
+  }
+  ASSERT_EQ(executor->count, 6);
+  // the same thread was reused
+  ASSERT_EQ(executor->pool.threadsCount(), 1);
+}
+
+TEST(ThreadedActionExecutor, ThreadPool)
+{
+  std::atomic_int done = 0;
+  {
+    BT::ThreadPool::Options options;
+    options.max_threads = 2;
+    BT::ThreadPool pool(options);
+    for(int i = 0; i < 20; i++)
+    {
+      pool.execute([&]() {
+        std::this_thread::sleep_for(milliseconds(1));
+        done++;
+      });
+    }
+    ASSERT_LE(pool.threadsCount(), 2);
+    // the destructor waits for all the tasks
+  }
+  ASSERT_EQ(done, 20);
+
+  // the default pool is shared
+  auto default_pool = BT::ThreadPool::defaultPool();
+  ASSERT_EQ(default_pool, BT::ThreadPool::defaultPool());
+}
+
+// Store the tasks, to run them later.
+struct ManualExecutor : public BT::Executor
+{
+  std::mutex mutex;
+  std::vector<Task> tasks;
+
+  void execute(Task task) override
+  {
+    std::unique_lock lk(mutex);
+    tasks.push_back(std::move(task));
+  }
+};
+
+struct CountingThreadedAction : public BT::ThreadedAction
+{
+  CountingThreadedAction(const std::string& name, const BT::NodeConfig& config,
+                         std::atomic_int* ticks) :
+    BT::ThreadedAction(name, config), ticks_(ticks)
+  {}
+
+  NodeStatus tick() override
+  {
+    (*ticks_)++;
+    return NodeStatus::SUCCESS;
+  }
+
+  static BT::PortsList providedPorts()
+  {
+    return {};
+  }
+
+private:
+  std::atomic_int* ticks_;
+};
+
+TEST(ThreadedActionExecutor, HaltWhileQueued)
+{
+  auto executor = std::make_shared<ManualExecutor>();
+  std::atomic_int ticks = 0;
+  BT::BehaviorTreeFactory factory;
+  factory.registerNodeType<CountingThreadedAction>("CountingThreadedAction", &ticks);
+  factory.setExecutor(executor);
+
+  auto tree = factory.createTreeFromText(R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <CountingThreadedAction/>
+        </BehaviorTree>
+    </root>)");
+
+  ASSERT_EQ(tree.tickOnce(), NodeStatus::RUNNING);
+  ASSERT_EQ(executor->tasks.size(), 1);
+
+  // halt() waits for the task: a worker picks it up later
+  std::thread worker([&]() {
+    std::this_thread::sleep_for(milliseconds(20));
+    std::unique_lock lk(executor->mutex);
+    executor->tasks.front()();
+  });
+  tree.haltTree();
+  worker.join();
+
+  ASSERT_EQ(ticks, 0);
+  ASSERT_EQ(tree.rootNode()->status(), NodeStatus::IDLE);
+}
+
+TEST(ThreadedActionExecutor, IdleTimeout)
+{
+  BT::ThreadPool::Options options;
+  options.idle_timeout = milliseconds(1);
+  BT::ThreadPool pool(options);
+  ASSERT_EQ(pool.options().max_threads, BT::ThreadPool::Unlimited);
+
+  std::atomic_int done = 0;
+  pool.execute([&]() { done++; });
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while ((done == 0 || pool.threadsCount() > 0) &&
+         std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  ASSERT_EQ(done, 1);
+  ASSERT_EQ(pool.threadsCount(), 0);
+
+  // a new thread is created when needed
+  pool.execute([&]() { done++; });
+  while (done == 1 && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  ASSERT_EQ(done, 2);
+}
+
+TEST(TickProfiler, InclusiveAndSelfTime)
+{
+  BT::BehaviorTreeFactory factory;
+  factory.registerSimpleAction("Slow", [](BT::TreeNode&) {
+    std::this_thread::sleep_for(milliseconds(2));
+    return NodeStatus::SUCCESS;
+  });
+  factory.registerSimpleAction("Fast", [](BT::TreeNode&) { return NodeStatus::SUCCESS; });
+
+  auto tree = factory.createTreeFromText(R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <Sequence name="root">
+                <Slow name="slow"/>
+                <Fast name="fast"/>
+            </Sequence>
+        </BehaviorTree>
+    </root>)");
+
+  BT::TickProfiler profiler(tree);
+  for(int i = 0; i < 3; i++)
+  {
+    ASSERT_EQ(tree.tickWhileRunning(), NodeStatus::SUCCESS);
+  }
+
+  const auto root_uid = tree.rootNode()->UID();
+  const auto root = profiler.statistics(root_uid);
+  ASSERT_EQ(root.ticks, 3);
+  ASSERT_GE(root.inclusive_total, milliseconds(6));
+  // most of the time is spent in the child
+  ASSERT_LT(root.self_total, root.inclusive_total / 2);
+
+  const auto all_stats = profiler.statistics();
+  ASSERT_EQ(all_stats.size(), 3);
+  for(const auto& stats : all_stats)
+  {
+    ASSERT_EQ(stats.ticks, 3);
+    if(stats.registration_name == "Slow")
+    {
+      ASSERT_GE(stats.self_total, milliseconds(6));
+      ASSERT_GE(BT::TickProfiler::percentile(stats.self_histogram, 50), milliseconds(2));
+    }
+  }
+
+  std::stringstream folded;
+  profiler.writeFoldedStacks(folded);
+  ASSERT_NE(folded.str().find("root;slow "), std::string::npos);
+
+  auto json = profiler.toJson();
+  ASSERT_EQ(json["nodes"].size(), 3);
+
+  std::stringstream table;
+  profiler.writeTable(table);
+  ASSERT_FALSE(table.str().empty());
+
+  profiler.reset();
+  ASSERT_EQ(profiler.statistics(root_uid).ticks, 0);
+}
+
+TEST(TickProfiler, ExceptionsAndLifetime)
+{
+  BT::BehaviorTreeFactory factory;
+  bool throw_exception = true;
+  factory.registerSimpleAction("Fast", [](BT::TreeNode&) { return NodeStatus::SUCCESS; });
+  factory.registerSimpleAction("Thrower", [&](BT::TreeNode&) {
+    if (throw_exception)
+    {
+      throw std::runtime_error("thrown by a node");
+    }
+    return NodeStatus::SUCCESS;
+  });
+
+  std::unique_ptr<BT::TickProfiler> profiler;
+  {
+    auto tree = factory.createTreeFromText(R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+            <Sequence name="root">
+                <Fast name="fast"/>
+                <Thrower name="thrower"/>
+            </Sequence>
+        </BehaviorTree>
+    </root>)");
+
+    profiler = std::make_unique<BT::TickProfiler>(tree);
+    const auto root_uid = tree.rootNode()->UID();
+    ASSERT_ANY_THROW(tree.tickOnce());
+    // the nodes interrupted by the exception are measured too
+    ASSERT_EQ(profiler->statistics(root_uid).ticks, 1);
+    ASSERT_EQ(profiler->statistics(root_uid + 2).ticks, 1);
+
+    throw_exception = false;
+    tree.haltTree();
+    ASSERT_EQ(tree.tickOnce(), NodeStatus::SUCCESS);
+    ASSERT_EQ(profiler->statistics(root_uid).ticks, 2);
+  }
+  // the tree was destroyed first: the results are still available
+  ASSERT_EQ(profiler->statistics().size(), 3);
+  ASSERT_EQ(profiler->statistics().front().path, "root");
+  profiler.reset();
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
 }
+
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "behaviortree_cpp/bt_factory.h"
+#include "behaviortree_cpp/tree_executor.h"
+
+using namespace BT;
+using std::chrono::milliseconds;
+
+class CountingAction : public BT::StatefulActionNode
+{
+public:
+  CountingAction(const std::string& name, const BT::NodeConfig& config) :
+    StatefulActionNode(name, config)
+  {}
+
+  static BT::PortsList providedPorts()
+  {
+    return {BT::InputPort<int>("cycles")};
+  }
+
+  NodeStatus onStart() override
+  {
+    count_ = 0;
+    return NodeStatus::RUNNING;
+  }
+
+  NodeStatus onRunning() override
+  {
+    if (getInput<int>("cycles").value() == -1)
+    {
+      throw RuntimeError("CountingAction failed");
+    }
+    return (++count_ >= getInput<int>("cycles").value()) ? NodeStatus::SUCCESS :
+                                                           NodeStatus::RUNNING;
+  }
+
+  void onHalted() override
+  {
+    halted_count++;
+  }
+
+  static std::atomic_int halted_count;
+
+private:
+  int count_ = 0;
+};
+
+std::atomic_int CountingAction::halted_count = 0;
+
+static const char* counting_xml = R"(
+<root BTCPP_format="4">
+  <BehaviorTree ID="MainTree">
+    <CountingAction cycles="{cycles}"/>
+  </BehaviorTree>
+</root>)";
+
+static std::shared_ptr<Tree> createCountingTree(BehaviorTreeFactory& factory, int cycles)
+{
+  auto blackboard = Blackboard::create();
+  blackboard->set("cycles", cycles);
+  return std::make_shared<Tree>(factory.createTreeFromText(counting_xml, blackboard));
+}
+
+TEST(TreeExecutor, ManyTrees)
+{
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<CountingAction>("CountingAction");
+
+  TreeExecutor executor(4);
+  ASSERT_EQ(executor.threadsCount(), 4);
+
+  const int trees_count = 200;
+  std::atomic_int completed = 0;
+  for (int i = 0; i < trees_count; i++)
+  {
+    executor.add(createCountingTree(factory, 5), milliseconds(1),
+                 [&](NodeStatus status, std::exception_ptr error) {
+                   if (status == NodeStatus::SUCCESS && !error)
+                   {
+                     completed++;
+                   }
+                 });
+  }
+  executor.waitAll();
+  ASSERT_EQ(completed, trees_count);
+  ASSERT_EQ(executor.treesCount(), 0);
+  // the first tick calls onStart()
+  ASSERT_EQ(executor.stats().ticks, trees_count * 6);
+}
+
+TEST(TreeExecutor, WakeUpAndRemove)
+{
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<CountingAction>("CountingAction");
+
+  TreeExecutor executor(2);
+
+  // period 0: ticked only when woken up
+  auto tree = createCountingTree(factory, 3);
+  std::atomic_bool done = false;
+  executor.add(tree, milliseconds(0),
+               [&](NodeStatus, std::exception_ptr) { done = true; });
+  std::this_thread::sleep_for(milliseconds(20));
+  ASSERT_EQ(executor.stats().ticks, 1);
+
+  for (int i = 0; i < 3 && !done; i++)
+  {
+    const auto ticks = executor.stats().ticks;
+    tree->wakeUpSignal()->emitSignal();
+    while (executor.stats().ticks == ticks)
+    {
+      std::this_thread::sleep_for(milliseconds(1));
+    }
+  }
+  executor.waitAll();
+  ASSERT_TRUE(done);
+  ASSERT_GE(executor.stats().wakeups, 3);
+
+  // this tree never completes, but it can be removed
+  CountingAction::halted_count = 0;
+  auto id = executor.add(createCountingTree(factory, 1000000), milliseconds(1),
+                         [&](NodeStatus, std::exception_ptr) { FAIL(); });
+  std::this_thread::sleep_for(milliseconds(20));
+  ASSERT_EQ(executor.treesCount(), 1);
+  ASSERT_TRUE(executor.remove(id));
+  ASSERT_FALSE(executor.remove(id));
+  ASSERT_EQ(executor.treesCount(), 0);
+  ASSERT_EQ(CountingAction::halted_count, 1);
+}
+
+TEST(TreeExecutor, Exception)
+{
+  BehaviorTreeFactory factory;
+  factory.registerNodeType<CountingAction>("CountingAction");
+
+  TreeExecutor executor(1);
+  std::exception_ptr received;
+  executor.add(createCountingTree(factory, -1), milliseconds(1),
+               [&](NodeStatus, std::exception_ptr error) { received = error; });
+  executor.waitAll();
+  ASSERT_TRUE(received);
+  ASSERT_THROW(std::rethrow_exception(received), RuntimeError);
+}
@@ -1,11 +1,14 @@
 #include <gtest/gtest.h>
 
 #include "behaviortree_cpp/scripting/operators.hpp"
+#include "behaviortree_cpp/scripting/bytecode.hpp"
 #include "behaviortree_cpp/bt_factory.h"
 #include "../sample_nodes/dummy_nodes.h"
 #include "test_helper.hpp"
 
 #include <lexy/input/string_input.hpp>
+#include <atomic>
+#include <thread>
 
 BT::Any GetScriptResult(BT::Ast::Environment& environment, const char* text)
 {
@@ -402,3 +405,158 @@ TEST(ParserTest, NewLine)
   ASSERT_EQ(tree.rootBlackboard()->get<int>("A"), 5);
   ASSERT_EQ(tree.rootBlackboard()->get<int>("B"), 6);
 }
+
+TEST(ParserTest, Bytecode)
+{
+  // the same scripts are executed by the AST interpreter and the compiled Program
+  BT::Ast::Environment ast_env = {BT::Blackboard::create(), {}};
+  BT::Ast::Environment vm_env = {BT::Blackboard::create(), {}};
+
+  const std::vector<const char*> scripts = {
+    "x:= 3; y:=5; x+y",   "x+=1",          "x * y - 2/4",
+    "x < y < 10",         "y < x < 10",    "(3+4)*2 == 14",
+    "-x",                 "~5",            "!(x > y)",
+    "x & 6",              "x | 1 ^ 2",     "x > 2 && y > 2",
+    "z := x > 2 ? 'big' : 'small'",        "z + 'ish'",
+    "z == 'big'",         "x",             "w := z; w",
+    "y /= 2; y",          "missing + 1",   "3 = 4",
+    "unknown = 1",        "z + 1",         "x = 'text'"
+  };
+
+  for (const char* script : scripts)
+  {
+    BT::Any ast_result;
+    BT::Any vm_result;
+    std::string ast_error;
+    std::string vm_error;
+    try
+    {
+      ast_result = GetScriptResult(ast_env, script);
+    }
+    catch (std::exception& err)
+    {
+      ast_error = err.what();
+    }
+    try
+    {
+      auto executor = BT::ParseScript(script);
+      ASSERT_TRUE(executor) << executor.error();
+      vm_result = executor.value()(vm_env);
+    }
+    catch (std::exception& err)
+    {
+      vm_error = err.what();
+    }
+
+    ASSERT_EQ(ast_error.empty(), vm_error.empty()) << script;
+    if (!vm_error.empty())
+    {
+      // the compiled script reports the source too
+      ASSERT_NE(vm_error.find(ast_error), std::string::npos) << script;
+      continue;
+    }
+    ASSERT_EQ(ast_result.type(), vm_result.type()) << script;
+    if (ast_result.isString())
+    {
+      ASSERT_EQ(ast_result.cast<std::string>(), vm_result.cast<std::string>());
+    }
+    else
+    {
+      ASSERT_EQ(ast_result.cast<double>(), vm_result.cast<double>()) << script;
+    }
+  }
+
+  for (auto key : {"x", "y", "z", "w"})
+  {
+    ASSERT_EQ(ast_env.vars->getAnyLocked(key)->type(),
+              vm_env.vars->getAnyLocked(key)->type());
+  }
+}
+
+TEST(ParserTest, BytecodeConstantFolding)
+{
+  auto executor = BT::ParseScript("(3+4)*2 == 14 ? 'A' : 'B'");
+  ASSERT_TRUE(executor);
+  auto program = executor.value().target<BT::Ast::ProgramExecutor>();
+  ASSERT_NE(program, nullptr);
+  ASSERT_TRUE(program->program().instructions().empty());
+
+  BT::Ast::Environment env = {BT::Blackboard::create(), {}};
+  ASSERT_EQ(executor.value()(env).cast<std::string>(), "A");
+
+  // entries are cached by the executor, but removing them is detected
+  auto assign = BT::ParseScript("c := c_value").value();
+  env.vars->set("c_value", 1);
+  assign(env);
+  env.vars->unset("c");
+  env.vars->set("c_value", 2);
+  assign(env);
+  ASSERT_EQ(env.vars->get<int>("c"), 2);
+}
+
+TEST(ParserTest, BytecodeConcurrentExecution)
+{
+  // the same ScriptFunction, shared by multiple threads
+  const auto script = BT::ParseScript("result := value * 2; result + 1").value();
+
+  std::vector<std::thread> threads;
+  std::atomic_int errors = 0;
+  for (int t = 0; t < 4; t++)
+  {
+    threads.emplace_back([&script, &errors, t]() {
+      BT::Ast::Environment env = {BT::Blackboard::create(), {}};
+      for (int i = 0; i < 1000; i++)
+      {
+        env.vars->set("value", t * 1000 + i);
+        const auto res = script(env).cast<int>();
+        if (res != (t * 1000 + i) * 2 + 1 || env.vars->get<int>("result") != res - 1)
+        {
+          errors++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  ASSERT_EQ(errors, 0);
+}
+
+TEST(ParserTest, ScriptCache)
+{
+  BT::BehaviorTreeFactory factory;
+
+  const std::string xml_text = R"(
+    <root BTCPP_format="4" >
+        <BehaviorTree ID="MainTree">
+          <Sequence>
+            <Script code="A:=1" />
+            <Script code="A+=1" _skipIf="A > 10" />
+            <Script code="A+=1" _skipIf="A > 10" />
+            <Script code="A+=1" _skipIf="A > 10" />
+          </Sequence>
+        </BehaviorTree>
+    </root>)";
+
+  auto cache = factory.scriptCache();
+  {
+    auto tree = factory.createTreeFromText(xml_text);
+    ASSERT_EQ(tree.tickWhileRunning(), BT::NodeStatus::SUCCESS);
+    ASSERT_EQ(tree.rootBlackboard()->get<int>("A"), 4);
+  }
+  ASSERT_EQ(cache->size(), 3);
+  ASSERT_EQ(cache->misses(), 3);
+  ASSERT_EQ(cache->hits(), 4);
+
+  // the second tree doesn't parse anything
+  auto tree = factory.createTreeFromText(xml_text);
+  ASSERT_EQ(cache->misses(), 3);
+  ASSERT_EQ(cache->hits(), 11);
+  ASSERT_EQ(tree.tickWhileRunning(), BT::NodeStatus::SUCCESS);
+  ASSERT_EQ(tree.rootBlackboard()->get<int>("A"), 4);
+
+  cache->clear();
+  ASSERT_EQ(cache->size(), 0);
+  ASSERT_EQ(cache->hits(), 0);
+}